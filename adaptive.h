@@ -0,0 +1,195 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include "apost.h"
+#include "dets.h"
+#include "interval.h"
+#include "leqs.h"
+#include "matrix.h"
+#include "precision.h"
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+/*
+    This file contains adaptive precision drivers for determinant and
+    linear equation system computations.
+
+    A computation is started at low precision. If the radius of the result
+    is larger than the required one, it is repeated at doubled precision,
+    and so on up to the maximal precision. Well-conditioned problems are
+    solved at 64-128 bits and only the hard ones pay for high precision.
+
+    The radius can not be made smaller than input errors contribution,
+    so escalation also stops when doubled precision does not halve the
+    finite radius.
+*/
+
+namespace interval {
+
+// Report of one computation attempt.
+struct PrecisionAttempt {
+    int precision;      // bits
+    double radius;      // maximal radius of the result, rounded up
+    double time;        // milliseconds
+};
+
+// Returns maximal radius of the result.
+inline Value max_radius(const ArbInterval& x) {
+    return x.error();
+}
+
+template<class IntervalT>
+Value max_radius(const Matrix<IntervalT>& x) {
+    Value radius;
+    for (size_t i = 0; i < x.nrow(); ++i) {
+        for (size_t j = 0; j < x.ncol(); ++j) {
+            Value r = x.at(i, j).error();
+            if (r > radius) {
+                radius = r;
+            }
+        }
+    }
+
+    return radius;
+}
+
+// Calls compute() at precisions min_precision, 2 * min_precision, ...
+// until the result radius is not greater than target, and returns the
+// last result. If attempts is not null, reports of all attempts are
+// appended to it.
+template<class Compute>
+auto adaptive_precision(Compute compute, double target,
+        std::vector<PrecisionAttempt>* attempts = nullptr,
+        int min_precision = 64, int max_precision = 4096)
+        -> decltype(compute()) {
+    double previous = 0;
+    for (int precision = min_precision; ; precision *= 2) {
+        PrecisionScope scope(precision);
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = compute();
+        auto end = std::chrono::steady_clock::now();
+
+        double radius = max_radius(result);
+        if (attempts) {
+            attempts->push_back({precision, radius,
+                std::chrono::duration<double, std::milli>(end - start).count()});
+        }
+
+        // input errors dominate, infinite radii (e.g. division by interval
+        // containing zero) are not saturated
+        bool saturated = precision != min_precision &&
+            std::isfinite(previous) && std::isfinite(radius) &&
+            radius > previous / 2;
+        if (radius <= target || saturated || 2 * precision > max_precision) {
+            return result;
+        }
+
+        previous = radius;
+    }
+}
+
+namespace apost {
+
+// Computes det(M) with dynamic aposteriori method (with pivoting).
+// The computation is recorded by controller, it is cleared before.
+inline ArbInterval det_apost(const Matrix<ArbInterval>& M,
+        Controller<ArbInterval>& controller) {
+    size_t n = M.nrow();
+
+    controller.clear();
+    ControllerScope<ArbInterval> scope(controller);
+
+    ArbInterval result;
+    {
+        Matrix<ProxyInterval<ArbInterval>> m(n, n);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                m.at(i, j) = M.at(i, j);
+
+        controller.init();
+        ProxyIntervalResult d;
+        d = det_pivot(m);
+        result = d;
+    }
+
+    return result;
+}
+
+// Solves the linear equation system with dynamic aposteriori method.
+// The computation is recorded by controller, it is cleared before.
+inline Matrix<ArbInterval> leq_apost(const Matrix<ArbInterval>& M,
+        Controller<ArbInterval>& controller) {
+    size_t n = M.nrow();
+    size_t m = M.ncol();
+
+    controller.clear();
+    ControllerScope<ArbInterval> scope(controller);
+
+    Matrix<ArbInterval> result(n, 1);
+    {
+        Matrix<ProxyInterval<ArbInterval>> s(n, m);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < m; ++j)
+                s.at(i, j) = M.at(i, j);
+
+        controller.init();
+        Matrix<ProxyIntervalResult> x = linear_solve_apost(s);
+        for (size_t i = 0; i < n; ++i)
+            result.at(i, 0) = x.at(i, 0);
+    }
+
+    return result;
+}
+
+// Uses its own controller, so the current controller is not changed.
+inline ArbInterval det_apost(const Matrix<ArbInterval>& M) {
+    Controller<ArbInterval> controller;
+    return det_apost(M, controller);
+}
+
+inline Matrix<ArbInterval> leq_apost(const Matrix<ArbInterval>& M) {
+    Controller<ArbInterval> controller;
+    return leq_apost(M, controller);
+}
+
+}  // namespace apost
+
+// Adaptive precision det_inv_pivot().
+inline ArbInterval det_adaptive(const Matrix<ArbInterval>& M, double target,
+        std::vector<PrecisionAttempt>* attempts = nullptr) {
+    return adaptive_precision([&] { return det_inv_pivot(M); },
+                              target, attempts);
+}
+
+// Adaptive precision leq_inv().
+inline Matrix<ArbInterval> leq_adaptive(const Matrix<ArbInterval>& M,
+        double target, std::vector<PrecisionAttempt>* attempts = nullptr) {
+    return adaptive_precision([&] { return leq_inv(M); }, target, attempts);
+}
+
+// Adaptive precision apost::det_apost().
+inline ArbInterval det_apost_adaptive(const Matrix<ArbInterval>& M,
+        double target, std::vector<PrecisionAttempt>* attempts = nullptr) {
+    return adaptive_precision([&] { return apost::det_apost(M); },
+                              target, attempts);
+}
+
+// Adaptive precision apost::leq_apost().
+inline Matrix<ArbInterval> leq_apost_adaptive(const Matrix<ArbInterval>& M,
+        double target, std::vector<PrecisionAttempt>* attempts = nullptr) {
+    return adaptive_precision([&] { return apost::leq_apost(M); },
+                              target, attempts);
+}
+
+}  // namespace interval
+
+#endif  // ADAPTIVE_H
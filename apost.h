@@ -7,8 +7,12 @@
 #define APOST_H
 
 #include "interval.h"
+#include "matrix.h"
+#include "tape_file.h"
 
-#include <functional>
+#include <algorithm>
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 #include <iostream>
@@ -38,21 +42,105 @@ namespace interval {
 
 namespace apost {
 
+template<class IntervalT>
+class Program;
+
+// Returns initial + x[0] * y[0] + ... + x[len - 1] * y[len - 1] (or
+// initial - ... if subtract), x[i] and y[i] are memory[operands[2 * i]]
+// and memory[operands[2 * i + 1]]. initial may be null.
+template<class IntervalT, class Memory>
+IntervalT dot(const IntervalT* initial, bool subtract,
+        const Memory& memory, const size_t* operands,
+        size_t len) {
+    IntervalT result;
+    if (initial) {
+        result = *initial;
+    }
+    
+    for (size_t i = 0; i < len; ++i) {
+        const IntervalT& x = memory[operands[2 * i]];
+        const IntervalT& y = memory[operands[2 * i + 1]];
+        if (subtract) {
+            result.submul(x, y);
+        } else {
+            result.addmul(x, y);
+        }
+    }
+    
+    return result;
+}
+
+// ArbInterval version is computed by arb_dot() with one rounding.
+// Operands are passed as shallow copies of arb_struct, arb_dot()
+// does not change them.
+template<class Memory>
+ArbInterval dot(const ArbInterval* initial, bool subtract,
+        const Memory& memory, const size_t* operands,
+        size_t len) {
+    std::vector<arb_struct> x(len);
+    std::vector<arb_struct> y(len);
+    for (size_t i = 0; i < len; ++i) {
+        x[i] = *memory[operands[2 * i]].data();
+        y[i] = *memory[operands[2 * i + 1]].data();
+    }
+    
+    ArbInterval result;
+    arb_dot(result.data(), initial ? initial->data() : nullptr, subtract,
+            x.data(), 1, y.data(), 1, len, getPrecision());
+    
+    return result;
+}
+
+/*
+    Coarse-grained tape node - a matrix operation (e.g. LU factorization)
+    recorded as a whole instead of O(n^3) scalar operations. Node outputs
+    are noutputs() contiguous Controller memory elements, its reverse
+    step computes adjoints of all inputs at once by a closed-form formula.
+*/
+template<class IntervalT>
+class Node {
+public:
+    Node(const std::vector<size_t>& inputs, size_t noutputs)
+    : inputs_(inputs)
+    , noutputs_(noutputs) {
+    }
+    
+    virtual ~Node() {}
+    
+    // Addresses of input values in Controller memory.
+    const std::vector<size_t>& inputs() const { return inputs_; }
+    
+    size_t noutputs() const { return noutputs_; }
+    
+    // Computes outputs from input values *inputs[i] (used by Program
+    // replay). Returns false if data dependent choices (pivots) differ
+    // from the recorded ones.
+    virtual bool forward(const IntervalT* const* inputs,
+            IntervalT* outputs) const = 0;
+    
+    // Sets input_adjoints[i] to the adjoint of i-th input for the given
+    // output adjoints. inputs - input values (as in forward()), outputs -
+    // output values.
+    virtual void reverse(const IntervalT* const* inputs,
+            const IntervalT* outputs, const IntervalT* output_adjoints,
+            IntervalT* input_adjoints) const = 0;
+    
+private:
+    std::vector<size_t> inputs_;
+    size_t noutputs_;
+};
+
 // Debug value can be set in user program.
 // If true shows error computation process.
 static bool debug = false;
 
 // TODO : 
-//  1) controller should be singleton;
-//  2) faster implementation of proxy object (there are at least extra call of 
-//      arithmetic operations in {+,-,*,/} operators);
-//  3) ProxyIntervalResult operator= maybe should not copy controller data;
-//  4) !!! remove interaction of user with controller class;
-//  5) faster implementation of (corr, null, inull) commands.
+//  1) !!! remove interaction of user with controller class.
 
 /*
     Controller class for apost error improvement method.
-    There is a static object of Controller class named "controller".
+    Every thread has its own default Controller object named "controller",
+    ControllerScope binds another one to the current thread (see below).
     It must be performed in the following order:
         1) set input ProxyInterval variables;
         2) call controller.init();
@@ -73,11 +161,108 @@ static bool debug = false;
 template<class IntervalT>
 class Controller {
 public:
+    // Reverse sweep modes.
+    enum Mode {
+        // Corr coefficients and adjoints are IntervalT values.
+        kIntervalMode,
+        // Corr coefficients are stored as upward rounded magnitudes (mag_t)
+        // of IntervalT coefficients and the whole reverse sweep runs in mag
+        // arithmetic. Gives a rigorous but possibly wider error bound, since
+        // adjoint contributions of different signs can not cancel.
+        kMagMode,
+        // Only operations are recorded, there are no reverse commands and
+        // coefficients. It is used to record Program (see apost_program.h),
+        // evaluate() returns traditionally computed values.
+        kOpsMode
+    };
+    
+    // Sets the reverse sweep mode.
+    // Must be called before init().
+    void set_mode(Mode mode) {
+        mode_ = mode;
+    }
+    
+    Mode mode() const { return mode_; }
+    
+    // Forward pass modes.
+    enum Forward {
+        // Values of operations are IntervalT intervals.
+        kIntervalForward,
+        // Values are points (midpoints). Operations on points keep only
+        // the rounding error bound as radius, it is moved to rounds_ pool
+        // and added to the apost error with the adjoint of the value, so
+        // there is no radius upkeep. Corr coefficients are derivatives at
+        // the midpoints, so second order terms in input radii and rounding
+        // errors are not bounded: the error is a first order estimate, not
+        // an enclosure (see ProxyIntervalResult::rigorous()).
+        kMidpointForward
+    };
+    
+    // Sets the forward pass mode.
+    // Must be called before init().
+    void set_forward(Forward forward) {
+        forward_ = forward;
+    }
+    
+    Forward forward() const { return forward_; }
+    
+    // Sets the precision of recorded operations and error evaluation.
+    // 0 (default) means the current thread precision.
+    void set_precision(int precision) {
+        precision_ = precision;
+    }
+    
+    int precision() const { return precision_; }
+    
+    // Streams reverse commands to binary file at path instead of memory
+    // (see tape_file.h), for computations whose commands do not fit
+    // in memory. Values of operations are kept in memory. Must be called
+    // after set_mode() and set_precision() and before init(). The file
+    // is kept by evaluate(outputs), so it can be evaluated again later.
+    // Returns false if the file can not be created, commands are kept
+    // in memory then. If the tape can not be written (e.g. the disk
+    // is full), evaluate(outputs) returns infinite errors.
+    bool spill(const std::string& path) {
+        tape_ = std::make_shared<TapeWriter>(path, mode_, precision_);
+        if (!tape_->good()) {
+            tape_.reset();
+            return false;
+        }
+        
+        tape_path_ = path;
+        return true;
+    }
+    
+    // Attaches tape file saved by spill() of another controller (e.g. in
+    // another process). evaluate(outputs) then returns errors of outputs
+    // as intervals [0 +/- error], values are not saved in tapes. Tapes
+    // with nodes can not be loaded. Returns false if the file is not
+    // a tape. Records of the tape are checked by evaluate(outputs), it
+    // returns infinite errors for corrupted tapes.
+    bool load(const std::string& path) {
+        TapeReader reader(path);
+        if (!reader.good() || reader.header().nodes != 0 ||
+                (reader.header().mode != kIntervalMode &&
+                 reader.header().mode != kMagMode)) {
+            return false;
+        }
+        
+        tape_.reset();
+        clear();
+        tape_path_ = path;
+        loaded_size_ = reader.header().size;
+        mode_ = static_cast<Mode>(reader.header().mode);
+        precision_ = reader.header().precision;
+        
+        return true;
+    }
+    
     // Initializes the controller. 
     // Must be called after all input variables 
     // setting and before computations.
     void init() {
         size_t last = memory_.size() - 1;
+        ninputs_ = memory_.size();
     
         // pushes
         // 1.      corr 0 (1, 0)
@@ -95,10 +280,10 @@ public:
         // to the controller commands list.
         
         // 1.
-        push_corr(0, 1);
+        push_corr_one(0);
         for (size_t i = 1; i < last; ++i) {
             push_inull(i);
-            push_corr(i, 1);
+            push_corr_one(i);
         }
         
         // 2.
@@ -111,40 +296,136 @@ public:
             push_corr(last - i, IntervalT(memory_[last - i].error()));
             push_inull(last - i);
         }
+        init_end_ = commands_.size();
+        
+        // input errors are in commands, operations use midpoints
+        if (forward_ == kMidpointForward) {
+            for (size_t i = 0; i <= last; ++i) {
+                memory_[i] = IntervalT(memory_[i].val());
+            }
+        }
     }
     
     // Computes and returns the error of last ProxyInterval
     // arithmetic operation result.
     // Clears Controller data after computtation.
     IntervalT evaluate() {
-        size_t last = commands_.size() - 1;
         IntervalT result = memory_.back();      // last computed value
+        result = evaluate(std::vector<size_t>(1, memory_.size() - 1))[0];
         
-        // set all memory_ to 0 and last element to 1
-        for (auto &i : memory_) {
-            i = 0;
-        }
-        memory_.back() = 1;
+        clear();
         
-        // call saved commands in reverse order
-        for (size_t i = 0; i <= last; ++i) {
-            commands_[last - i]();
-        }
+        return result;
+    }
+    
+    // Computes errors of several output values in one reverse pass.
+    // outputs - addresses of output values in Controller memory.
+    // Returns output values with apost computed errors (estimates in
+    // kMidpointForward, see Forward).
+    // Controller data is not changed, so it can be called many times.
+    std::vector<IntervalT> evaluate(const std::vector<size_t>& outputs) const {
+        PrecisionScope scope(precision_);
         
-        // result error contains in first memory_ element
-        result = IntervalT(result.val(), memory_[0].val() + memory_[0].error());
+        if (mode_ == kOpsMode) {
+            std::vector<IntervalT> results;
+            for (size_t addr : outputs) {
+                results.push_back(memory_[addr]);
+            }
+            return results;
+        }
+        if (mode_ == kMagMode) {
+            return evaluate_lanes<Magnitude>(outputs, mag_coefs_);
+        }
         
-        // clear all
+        return evaluate_lanes<IntervalT>(outputs, coefs_);
+    }
+    
+    // Clears all recorded data. Modes and precision are not changed and
+    // allocated memory is kept, so the controller can record the next
+    // computation without reallocations.
+    void clear() {
         memory_.clear();
         commands_.clear();
-       
-        return result;
+        coefs_.clear();
+        mag_coefs_.clear();
+        ops_.clear();
+        nodes_.clear();
+        operands_.clear();
+        rounds_.clear();
+        node_rounds_.clear();
+        guards_.clear();
+        guard_addrs_.clear();
+        ninputs_ = 0;
+        init_end_ = 0;
+        loaded_size_ = 0;
+        
+        // the next computation is written from the beginning of the tape
+        if (tape_) {
+            tape_ = std::make_shared<TapeWriter>(tape_path_, mode_, precision_);
+        } else {
+            tape_path_.clear();
+        }
     }
-
+    
     // Pushes new interval value to Controller memory and returns its address.
+    // In kMidpointForward radius of value pushed after init() is kept
+    // as rounding error of the constant.
+    
+    // pushes (kMidpointForward, constants with nonzero radius only)
+    //         rnull last
     size_t push_value(const IntervalT& value) {
-        memory_.push_back(value);
-        return memory_.size() - 1;
+        ops_.push_back({kValue, 0, 0});
+        
+        if (forward_ != kMidpointForward || ninputs_ == 0 ||
+                value.error() == Value()) {
+            memory_.push_back(value);
+            return memory_.size() - 1;
+        }
+        
+        size_t last = push_result(value);
+        push_null(last);
+        
+        return last;
+    }
+    
+    // Pushes node with output values to Controller memory and returns
+    // the address of its first output.
+    
+    // pushes
+    //         node first
+    // to the controller commands list.
+    size_t push_node(std::shared_ptr<const Node<IntervalT>> node,
+            const std::vector<IntervalT>& outputs) {
+        size_t first = memory_.size();
+        size_t index = nodes_.size();
+        nodes_.push_back(node);
+        node_rounds_.push_back(rounds_.size());
+        
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            memory_.push_back(outputs[i]);
+            ops_.push_back({kNodeOutput, index, i});
+            
+            // output radii are rounding errors of the node
+            if (forward_ == kMidpointForward) {
+                rounds_.push_back(Magnitude(outputs[i].error()));
+                memory_.back() = IntervalT(outputs[i].val());
+            }
+        }
+        
+        push_command(kNode, first, index);
+        
+        return first;
+    }
+    
+    // Records the pivot choice made among candidates memory_ elements.
+    // pivot is the index of chosen element in candidates or -1.
+    // Pivot choices are checked when the computations are replayed
+    // as Program.
+    void push_pivot(const std::vector<size_t>& candidates, int pivot) {
+        guards_.push_back({memory_.size(), guard_addrs_.size(),
+                           candidates.size(), pivot});
+        guard_addrs_.insert(guard_addrs_.end(),
+                            candidates.begin(), candidates.end());
     }
 
     // Pushes memory_[a] + memory_[b] to Controller and returns
@@ -156,11 +437,12 @@ public:
     //         corr a (1, 0)
     //         null last
     size_t add(size_t a, size_t b) {
-        memory_.push_back(memory_[a] + memory_[b]);
-        size_t last = memory_.size() - 1;
+        PrecisionScope scope(precision_);
+        size_t last = push_result(memory_[a] + memory_[b]);
+        ops_.push_back({kAdd, a, b});
         
-        push_corr(b, 1);
-        push_corr(a, 1);
+        push_corr_one(b);
+        push_corr_one(a);
         push_null(last);
         
         return last;
@@ -175,11 +457,12 @@ public:
     //         corr a (1, 0)
     //         null last
     size_t sub(size_t a, size_t b) {
-        memory_.push_back(memory_[a] - memory_[b]);
-        size_t last = memory_.size() - 1;
+        PrecisionScope scope(precision_);
+        size_t last = push_result(memory_[a] - memory_[b]);
+        ops_.push_back({kSub, a, b});
         
-        push_corr(b, -1);
-        push_corr(a, 1);
+        push_corr_minus_one(b);
+        push_corr_one(a);
         push_null(last);
         
         return last;
@@ -194,8 +477,9 @@ public:
     //         corr a (memory_[b], 0)
     //         null last
     size_t mul(size_t a, size_t b) {
-        memory_.push_back(memory_[a] * memory_[b]);
-        size_t last = memory_.size() - 1;
+        PrecisionScope scope(precision_);
+        size_t last = push_result(memory_[a] * memory_[b]);
+        ops_.push_back({kMul, a, b});
         
         push_corr(b, memory_[a]);
         push_corr(a, memory_[b]);
@@ -213,9 +497,12 @@ public:
     //         corr a ( (1, 0) / memory_[b] )
     //         null last
     size_t div(size_t a, size_t b) {
-        memory_.push_back(memory_[a] / memory_[b]);
-        
-        size_t last = memory_.size() - 1;
+        PrecisionScope scope(precision_);
+        size_t last = push_result(memory_[a] / memory_[b]);
+        ops_.push_back({kDiv, a, b});
+        if (mode_ == kOpsMode) {
+            return last;
+        }
         
         // temp = -memory_[a] / memory_[b] / memor_[b]
         IntervalT temp = -memory_[a];
@@ -229,6 +516,60 @@ public:
         return last;
     }
     
+    // Address value for absent operand.
+    static const size_t kNone = static_cast<size_t>(-1);
+    
+    // Pushes memory_[initial] + sum of memory_[x[i]] * memory_[y[i]] (or
+    // memory_[initial] - sum if subtract) to Controller as one operation
+    // with one rounding and returns its address. initial may be kNone.
+    // pushes
+    // corresponding to dot product controller operations:
+    //         corr initial (1, 0)
+    //         corr y[0] (+/- memory_[x[0]])
+    //         corr x[0] (+/- memory_[y[0]])
+    //         ...
+    //         null last
+    size_t dot(size_t initial, bool subtract, const std::vector<size_t>& x,
+            const std::vector<size_t>& y) {
+        PrecisionScope scope(precision_);
+        size_t len = x.size();
+        size_t first = operands_.size();
+        
+        operands_.push_back(initial);
+        for (size_t i = 0; i < len; ++i) {
+            operands_.push_back(x[i]);
+            operands_.push_back(y[i]);
+        }
+        
+        size_t last = push_result(apost::dot(
+            initial == kNone ? nullptr : &memory_[initial], subtract,
+            memory_, &operands_[first + 1], len));
+        ops_.push_back({subtract ? kDotSub : kDot, first, len});
+        if (mode_ == kOpsMode) {
+            return last;
+        }
+        
+        if (initial != kNone) {
+            push_corr_one(initial);
+        }
+        for (size_t i = 0; i < len; ++i) {
+            if (subtract) {
+                push_corr(y[i], -memory_[x[i]]);
+                push_corr(x[i], -memory_[y[i]]);
+            } else {
+                push_corr(y[i], memory_[x[i]]);
+                push_corr(x[i], memory_[y[i]]);
+            }
+        }
+        push_null(last);
+        
+        return last;
+    }
+    
+    // Returns value of memory element, throws std::out_of_range for
+    // address out of memory (e.g. after clear()).
+    const IntervalT& value(size_t addr) const { return memory_.at(addr); }
+    
     // Prints the memory content.
     void print() const {
         for (auto x : memory_) {
@@ -236,15 +577,40 @@ public:
         }
     }
     
+    Controller() = default;
+    Controller(Controller&&) = default;
+    
+    // Copies would write the same tape file.
+    Controller(const Controller&) = delete;
+    
     // Assignment operator uses in ProxyIntervalResult.
     Controller& operator=(Controller other) {
         swap(memory_, other.memory_);
         swap(commands_, other.commands_);
+        swap(coefs_, other.coefs_);
+        swap(mag_coefs_, other.mag_coefs_);
+        swap(ops_, other.ops_);
+        swap(nodes_, other.nodes_);
+        swap(operands_, other.operands_);
+        swap(rounds_, other.rounds_);
+        swap(node_rounds_, other.node_rounds_);
+        swap(guards_, other.guards_);
+        swap(guard_addrs_, other.guard_addrs_);
+        std::swap(ninputs_, other.ninputs_);
+        std::swap(init_end_, other.init_end_);
+        std::swap(tape_, other.tape_);
+        std::swap(tape_path_, other.tape_path_);
+        std::swap(loaded_size_, other.loaded_size_);
+        std::swap(mode_, other.mode_);
+        std::swap(forward_, other.forward_);
+        std::swap(precision_, other.precision_);
         
         return *this;
     }
     
 private:
+    friend class Program<IntervalT>;
+
     /*
         Controller class uses 3 simple commands and s_ aggregation value
         to compute error.
@@ -260,151 +626,748 @@ private:
         inull "addr"
             sets s_ = abs(memory_[addr]) and memory_[addr] = 0
             
+        rnull "addr" "magnitude"
+            does null "addr" and adds |s_| * magnitude (rounding error
+            of memory_[addr] in kMidpointForward) to the result error
+            
+        node "addr"
+            adds adjoints of the node inputs to theirs memory_ elements,
+            sets memory_ elements of node outputs (from addr) to 0
+            
         
         This comands stores in commands_ vector during computation using
-        push_corr, push_null and push_inull methods.
-        Finally in evaluate methods pushed functions calls in reverse order
+        push_corr, push_null and push_inull methods. Each command is a plain
+        {opcode, address, coefficient slot} record, interval coefficients
+        are kept apart in coefs_ pool (mag_coefs_ pool in kMagMode). Corr with (1, 0) and (-1, 0)
+        coefficients has its own opcodes and does not use the pool.
+        Finally evaluate method interprets commands in reverse order
         and computed error is in memory_[0].
     */
+    
+    enum Opcode : unsigned char {
+        kCorr,              // corr addr coefs_[coef] (or mag_coefs_[coef])
+        kCorrOne,           // corr addr (1, 0)
+        kCorrMinusOne,      // corr addr (-1, 0)
+        kNull,              // null addr
+        kInull,             // inull addr
+        kNullRound,         // rnull addr rounds_[coef]
+        kNode               // node addr (first output), nodes_[coef]
+    };
+    
+    struct Command {
+        Opcode op;
+        size_t addr;
+        size_t coef;        // index in coefficients pool, kCorr only
+    };
+    
+    // Returns opcode name for debug output.
+    static const char* name(Opcode op) {
+        switch (op) {
+        case kNull:
+            return "null";
+        case kInull:
+            return "inull";
+        case kNullRound:
+            return "rnull";
+        case kNode:
+            return "node";
+        default:
+            return "corr";
+        }
+    }
 
     std::vector<IntervalT> memory_;
-    std::vector<std::function<void()>> commands_;
+    std::vector<Command> commands_;
+    std::vector<IntervalT> coefs_;
+    std::vector<Magnitude> mag_coefs_;
+    
+    Mode mode_ = kIntervalMode;
+    Forward forward_ = kIntervalForward;
+    
+    // Rounding errors of kMidpointForward values, node_rounds_[i] is
+    // the index of the first output rounding error of nodes_[i].
+    std::vector<Magnitude> rounds_;
+    std::vector<size_t> node_rounds_;
+    int precision_ = 0;
+    
+    // Number of commands pushed by init().
+    size_t init_end_ = 0;
+    
+    // Commands are in the tape file at tape_path_: written by tape_ or
+    // loaded with loaded_size_ memory elements.
+    std::shared_ptr<TapeWriter> tape_;
+    std::string tape_path_;
+    size_t loaded_size_ = 0;
+    
+    /*
+        Besides the reverse commands Controller keeps forward operations
+        (one per memory_ element) and pivot choices made during computation.
+        They are not used by evaluate(), but allow to freeze computations
+        into a Program and replay them with new input values.
+    */
+    
+    enum OpKind : unsigned char {
+        kValue,             // input (before init()) or constant value
+        kAdd,               // memory_[a] + memory_[b]
+        kSub,               // memory_[a] - memory_[b]
+        kMul,               // memory_[a] * memory_[b]
+        kDiv,               // memory_[a] / memory_[b]
+        kDot,               // dot product of b operands pairs from
+                            // operands_[a] (initial, x[0], y[0], ...)
+        kDotSub,            // the same with subtraction
+        kNodeOutput         // b-th output of nodes_[a]
+    };
+    
+    struct Operation {
+        OpKind kind;
+        size_t a;
+        size_t b;
+    };
+    
+    // Pivot choice made when memory_ had position elements. Candidates
+    // addresses are guard_addrs_[first], ..., guard_addrs_[first + count - 1].
+    struct Guard {
+        size_t position;
+        size_t first;
+        size_t count;
+        int pivot;
+    };
+    
+    std::vector<Operation> ops_;
+    std::vector<std::shared_ptr<const Node<IntervalT>>> nodes_;
+    std::vector<size_t> operands_;
+    std::vector<Guard> guards_;
+    std::vector<size_t> guard_addrs_;
+    size_t ninputs_ = 0;
+    
+    /*
+        Reverse pass for k output values at once (vector mode). Every
+        memory element has k adjoints, one per output, they are stored
+        contiguously in one flat block: adjoints[addr * k + lane]. s_
+        aggregation value also has k lanes. So one traversal of commands
+        gives the errors of all outputs and each command is decoded once
+        for all of them.
+        
+        AdjointT is IntervalT for kIntervalMode and Magnitude for kMagMode
+        (the adjoints are upper bounds of absolute values then).
+    */
+    template<class AdjointT, class CoefT>
+    std::vector<IntervalT> evaluate_lanes(const std::vector<size_t>& outputs,
+            const std::vector<CoefT>& coefs) const {
+        size_t k = outputs.size();
+        bool tape = !tape_path_.empty();
+        // false if the tape is not written or corrupted, errors are
+        // infinite then
+        bool valid = true;
+        if (tape_) {
+            valid = tape_->flush(memory_.size(), nodes_.size());
+        }
+        
+        size_t size = tape && memory_.empty() ? loaded_size_ : memory_.size();
+        std::vector<AdjointT> adjoints(size * k);
+        std::vector<AdjointT> s(k);
+        // sum of |adjoint| * rounding error, kMidpointForward only
+        std::vector<AdjointT> rounding(k);
+        bool midpoint = forward_ == kMidpointForward;
+        
+        for (size_t j = 0; j < k; ++j) {
+            if (outputs[j] < size) {
+                adjoints[outputs[j] * k + j] = 1;
+            } else {
+                valid = false;
+            }
+        }
+        
+        // coef - corr coefficient, round - rnull rounding error
+        auto execute = [&] (const Command& command, const CoefT* coef,
+                            const Magnitude* round) {
+            AdjointT* x = &adjoints[command.addr * k];
+            
+            if (debug) {
+                std::cerr << name(command.op) << ": " << command.addr;
+                if (command.op == kCorr)
+                    std::cerr << " " << *coef;
+                std::cerr << " " << s[0] << std::endl;
+            }
+            
+            switch (command.op) {
+            case kCorr:
+                for (size_t j = 0; j < k; ++j)
+                    x[j].addmul(*coef, s[j]);
+                break;
+            case kCorrOne:
+                for (size_t j = 0; j < k; ++j)
+                    x[j] += s[j];
+                break;
+            case kCorrMinusOne:
+                for (size_t j = 0; j < k; ++j)
+                    corr_minus_one(x[j], s[j]);
+                break;
+            case kNull:
+                for (size_t j = 0; j < k; ++j) {
+                    s[j].swap(x[j]);
+                    x[j].zero();
+                }
+                break;
+            case kInull:
+                for (size_t j = 0; j < k; ++j) {
+                    abs(x[j]);
+                    s[j].swap(x[j]);
+                    x[j].zero();
+                }
+                break;
+            case kNullRound:
+                for (size_t j = 0; j < k; ++j) {
+                    s[j].swap(x[j]);
+                    x[j].zero();
+                    add_rounding(rounding[j], s[j], *round);
+                }
+                break;
+            case kNode:
+                reverse_node(*nodes_[command.coef], command.addr,
+                    memory_.data(), adjoints, k,
+                    midpoint ? &rounds_[node_rounds_[command.coef]] : nullptr,
+                    rounding.data());
+                break;
+            }
+        };
+        
+        // interpret saved commands in reverse order
+        if (tape) {
+            TapeReader reader(tape_path_);
+            TapeRecord record;
+            const char* payload;
+            CoefT coef;
+            Magnitude round;
+            
+            // the file is replaced after spill() or load()
+            valid = valid && reader.good();
+            while (valid && reader.previous(record, payload)) {
+                Command command = {static_cast<Opcode>(record.op),
+                                   record.addr, record.coef};
+                valid = valid_record(record, size);
+                if (valid && command.op == kCorr) {
+                    valid = apost::load(payload, record.length, coef);
+                } else if (valid && command.op == kNullRound) {
+                    valid = apost::load(payload, record.length, round);
+                }
+                if (valid) {
+                    execute(command, &coef, &round);
+                }
+            }
+            valid = valid && reader.good() && !reader.corrupted();
+        } else {
+            std::vector<bool> live = live_commands(outputs);
+            
+            for (size_t i = commands_.size(); i-- > 0; ) {
+                if (!live[i]) {
+                    continue;
+                }
+                
+                const Command& command = commands_[i];
+                execute(command,
+                    command.op == kCorr ? &coefs[command.coef] : nullptr,
+                    command.op == kNullRound ? &rounds_[command.coef] : nullptr);
+            }
+        }
+        
+        // result errors contain in first memory_ element adjoints
+        std::vector<IntervalT> results;
+        for (size_t j = 0; j < k; ++j) {
+            Value value = outputs[j] < memory_.size() ?
+                memory_[outputs[j]].val() : Value();
+            Value error = error_bound(adjoints[j]) + error_bound(rounding[j]);
+            if (!valid) {
+                arf_pos_inf(error.data_);
+            }
+            results.push_back(IntervalT(value, error));
+        }
+        
+        return results;
+    }
+    
+    /*
+        Tape pruning before the reverse pass. Commands of an operation are
+        its corr commands followed by null (rnull) of its result, a node
+        has one node command. A value is live if it is an output or
+        an operand of a live operation (input of a live node). The adjoint
+        of a value which is not live is zero, so commands of its operation
+        add nothing and are skipped: e.g. L factors of elimination when
+        only U is used, or values of discarded ProxyInterval objects.
+        
+        Liveness is found by one backward pass over commands without
+        arithmetic. Commands of init() are always executed.
+    */
+    std::vector<bool> live_commands(const std::vector<size_t>& outputs) const {
+        std::vector<bool> live(commands_.size());
+        std::vector<bool> live_values(memory_.size());
+        // addresses out of memory are not values, evaluate_lanes()
+        // returns infinite errors for them
+        for (size_t addr : outputs) {
+            if (addr < memory_.size()) {
+                live_values[addr] = true;
+            }
+        }
+        
+        // the current operation is live
+        bool op_live = false;
+        for (size_t i = commands_.size(); i-- > init_end_; ) {
+            const Command& command = commands_[i];
+            switch (command.op) {
+            case kNull:
+            case kNullRound:
+                op_live = live_values[command.addr];
+                break;
+            case kNode: {
+                const Node<IntervalT>& node = *nodes_[command.coef];
+                op_live = false;
+                for (size_t j = 0; j < node.noutputs(); ++j) {
+                    op_live = op_live || live_values[command.addr + j];
+                }
+                for (size_t j = 0; op_live && j < node.inputs().size(); ++j) {
+                    live_values[node.inputs()[j]] = true;
+                }
+                break;
+            }
+            default:
+                if (op_live) {
+                    live_values[command.addr] = true;
+                }
+                break;
+            }
+            live[i] = op_live;
+        }
+        
+        for (size_t i = 0; i < init_end_; ++i) {
+            live[i] = true;
+        }
+        
+        if (debug) {
+            std::cerr << "live commands: "
+                      << std::count(live.begin(), live.end(), true)
+                      << " of " << commands_.size() << std::endl;
+        }
+        
+        return live;
+    }
+    
+    // Lane operations of evaluate_lanes(). In kMagMode adjoints are
+    // magnitudes, so corr (-1, 0) adds and inull does not need abs.
+    static void corr_minus_one(IntervalT& x, const IntervalT& s) { x -= s; }
+    static void corr_minus_one(Magnitude& x, const Magnitude& s) { x += s; }
     
-    IntervalT s_;
+    static void abs(IntervalT& x) { x.abs(); }
+    static void abs(Magnitude&) {}
+    
+    // Returns true if tape record is a command of memory with size
+    // elements: its opcode, address and node are valid.
+    bool valid_record(const TapeRecord& record, size_t size) const {
+        if (record.op > kNode || record.addr >= size) {
+            return false;
+        }
+        if (record.op != kNode) {
+            return true;
+        }
+        
+        return record.coef < nodes_.size() &&
+               nodes_[record.coef]->noutputs() <= size - record.addr;
+    }
+    
+    static Value error_bound(const IntervalT& x) { return x.val() + x.error(); }
+    static Value error_bound(const Magnitude& x) { return x.val(); }
+    
+    // Node adjoints are computed in IntervalT, magnitude m is
+    // the interval [-m, m].
+    static IntervalT to_interval(const IntervalT& x) { return x; }
+    static IntervalT to_interval(const Magnitude& x) {
+        return IntervalT(Value(), x.val());
+    }
+    
+    static void add_adjoint(IntervalT& x, const IntervalT& y) { x += y; }
+    static void add_adjoint(Magnitude& x, const IntervalT& y) { x += y.mag(); }
+    
+    // Adds |s| * r to rounding error x.
+    static void add_rounding(IntervalT& x, const IntervalT& s,
+            const Magnitude& r) {
+        x.addmul(IntervalT(s.mag().val()), IntervalT(r.val()));
+    }
+    static void add_rounding(Magnitude& x, const Magnitude& s,
+            const Magnitude& r) {
+        x.addmul(s, r);
+    }
+    
+    // Reverse step of node with outputs from address first, lane by lane.
+    // values - memory elements (used by Program replay too). If rounds is
+    // not null, rounding errors of outputs are added to rounding[lane].
+    template<class AdjointT>
+    static void reverse_node(const Node<IntervalT>& node, size_t first,
+            const IntervalT* values, std::vector<AdjointT>& adjoints,
+            size_t k, const Magnitude* rounds = nullptr,
+            AdjointT* rounding = nullptr) {
+        const std::vector<size_t>& inputs = node.inputs();
+        std::vector<IntervalT> output_adjoints(node.noutputs());
+        std::vector<IntervalT> input_adjoints(inputs.size());
+        std::vector<const IntervalT*> input_values(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            input_values[i] = &values[inputs[i]];
+        }
+        
+        for (size_t j = 0; j < k; ++j) {
+            for (size_t i = 0; i < node.noutputs(); ++i) {
+                AdjointT& x = adjoints[(first + i) * k + j];
+                if (rounds) {
+                    add_rounding(rounding[j], x, rounds[i]);
+                }
+                output_adjoints[i] = to_interval(x);
+                x.zero();
+            }
+            
+            node.reverse(input_values.data(), values + first,
+                         output_adjoints.data(), input_adjoints.data());
+            
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                add_adjoint(adjoints[inputs[i] * k + j], input_adjoints[i]);
+            }
+        }
+    }
+    
+    // Pushes command to commands vector (or to the tape).
+    void push_command(Opcode op, size_t a, size_t coef = 0) {
+        if (mode_ == kOpsMode) {
+            return;
+        }
+        if (tape_) {
+            tape_->push(op, a, coef);
+            return;
+        }
+        
+        commands_.push_back({op, a, coef});
+    }
     
     // Pushes corr command to commands vector.
-    void push_corr(size_t a, IntervalT x) {
-        commands_.push_back( [a, x, this] {
-            if (debug) 
-                std::cerr << "corr: " << a << " " << x << " " << s_ << std::endl;
-            memory_[a] += x * s_;
-        } );
+    void push_corr(size_t a, const IntervalT& x) {
+        if (mode_ == kOpsMode) {
+            return;
+        }
+        if (tape_ && mode_ == kMagMode) {
+            tape_->push(kCorr, a, 0, x.mag());
+            return;
+        }
+        if (tape_) {
+            tape_->push(kCorr, a, 0, x);
+            return;
+        }
+        
+        if (mode_ == kMagMode) {
+            mag_coefs_.push_back(x.mag());
+            commands_.push_back({kCorr, a, mag_coefs_.size() - 1});
+            return;
+        }
+        
+        coefs_.push_back(x);
+        commands_.push_back({kCorr, a, coefs_.size() - 1});
+    }
+    
+    // Pushes corr command with (1, 0) coefficient to commands vector.
+    void push_corr_one(size_t a) {
+        push_command(kCorrOne, a);
+    }
+    
+    // Pushes corr command with (-1, 0) coefficient to commands vector.
+    void push_corr_minus_one(size_t a) {
+        push_command(kCorrMinusOne, a);
     }
     
-    // Pushes null command to commands vector.
+    // Pushes value of operation (or constant) to memory_ and returns its
+    // address. In kMidpointForward operands are points, so the radius of
+    // value is its rounding error. It is moved to rounds_ for the rnull
+    // command of the value (see push_null()) and the value becomes
+    // a point. Values computed before init() are inputs, init() takes
+    // their radii.
+    size_t push_result(const IntervalT& value) {
+        memory_.push_back(value);
+        
+        if (forward_ == kMidpointForward && ninputs_ > 0) {
+            if (mode_ != kOpsMode) {
+                rounds_.push_back(Magnitude(value.error()));
+            }
+            memory_.back() = IntervalT(value.val());
+        }
+        
+        return memory_.size() - 1;
+    }
+    
+    // Pushes null command to commands vector. Null of kMidpointForward
+    // value is rnull with its rounding error.
     void push_null(size_t a) {
-        commands_.push_back( [a, this] {
-            if (debug)
-                std::cerr << "null: " << a <<  " " << s_ << std::endl;
-            s_ = memory_[a];
-            memory_[a].zero(); 
-        } );
+        if (mode_ == kOpsMode) {
+            return;
+        }
+        if (forward_ == kMidpointForward && ninputs_ > 0 && tape_) {
+            // the rounding error is in the record
+            tape_->push(kNullRound, a, 0, rounds_.back());
+            rounds_.pop_back();
+            return;
+        }
+        if (forward_ == kMidpointForward && ninputs_ > 0) {
+            commands_.push_back({kNullRound, a, rounds_.size() - 1});
+            return;
+        }
+        
+        push_command(kNull, a);
     }
     
     // Pushes inull command to commands vector.
     void push_inull(size_t a) {
-        commands_.push_back( [a, this] {
-            if (debug)
-                std::cerr << "inull: " << a <<  " " << s_ << std::endl;
-            memory_[a].abs();
-            s_ = memory_[a];
-            memory_[a].zero(); 
-        } );
+        push_command(kInull, a);
+    }
+};
+
+namespace context {
+
+// Default controller of the current thread.
+template<class IntervalT>
+Controller<IntervalT>& local() {
+    thread_local Controller<IntervalT> value;
+    return value;
+}
+
+// Controller bound by ControllerScope, null if the default one is used.
+template<class IntervalT>
+Controller<IntervalT>*& bound() {
+    thread_local Controller<IntervalT>* value = nullptr;
+    return value;
+}
+
+}  // namespace context
+
+// Returns the controller used by ProxyInterval<IntervalT> values of the
+// current thread: the one bound by the innermost ControllerScope or the
+// default controller of the thread. Controllers of different threads are
+// independent, so threads can record and evaluate at the same time.
+template<class IntervalT>
+Controller<IntervalT>& get_controller() {
+    Controller<IntervalT>* bound = context::bound<IntervalT>();
+    return bound ? *bound : context::local<IntervalT>();
+}
+
+/*
+    Binds controller to the current thread while the object is alive,
+    the previous one is restored by destructor. Scopes can be nested.
+    ProxyInterval values belong to the controller which was current
+    when they were created, they must not be used outside of the scope.
+    
+        Controller<ArbInterval> c;
+        {
+            ControllerScope<ArbInterval> scope(c);
+            ... ProxyInterval computations recorded by c ...
+        }
+*/
+template<class IntervalT>
+class ControllerScope {
+public:
+    explicit ControllerScope(Controller<IntervalT>& controller)
+    : saved_(context::bound<IntervalT>()) {
+        context::bound<IntervalT>() = &controller;
+    }
+    
+    ~ControllerScope() {
+        context::bound<IntervalT>() = saved_;
     }
+    
+    ControllerScope(const ControllerScope&) = delete;
+    ControllerScope& operator=(const ControllerScope&) = delete;
+    
+private:
+    Controller<IntervalT>* saved_;
 };
 
-static Controller<ArbInterval> controller;
+// Default ArbInterval controller of the current thread. It is the same
+// object in all translation units. Inside ControllerScope use
+// get_controller<ArbInterval>() instead.
+static thread_local Controller<ArbInterval>& controller =
+    context::local<ArbInterval>();
 
 
 // Proxy class for apost interval computations.
 // In addition to traditional computing adds reverse commands to controller.
 template<class IntervalT>
 struct ProxyInterval {
-    // Constructors
-    ProxyInterval() {
-        data_.zero();
-        addr_ = 0;
+    // Constructs exact zero. It is pushed to controller memory when
+    // its address is used first.
+    ProxyInterval()
+    : addr_(kZero) {
     }
     
     // Constructor to init ProxyInterval from simple interval.
     // New object has the new address in controller object.
-    ProxyInterval(const IntervalT& other) {
-        data_ = other;
-        addr_ = controller.push_value(other);
+    ProxyInterval(const IntervalT& other)
+    : addr_(get_controller<IntervalT>().push_value(other)) {
     }
     
-    // Constructor to init ProxyInterval from other ProxyInterval.
-    // New object has the same address as other in controller object.
-    ProxyInterval& operator=(const ProxyInterval& other) {
-        data_ = other.data_;
-        addr_ = other.addr_;
+    // Returns ProxyInterval of value which is already in controller
+    // memory at addr (e.g. node output).
+    static ProxyInterval at(size_t addr) {
+        ProxyInterval temp;
+        temp.addr_ = addr;
+        return temp;
     }
     
     // Simple interval cast operator.
-    operator IntervalT() const { return data_; }
+    operator IntervalT() const { return data(); }
 
-    // ProxyInterval arithmetical operations computes the corresponding
-    // value and calls controller method to add this value to memory and
-    // push required inversion operations.
+    // ProxyInterval arithmetical operations call controller method to
+    // compute the corresponding value, add it to memory and push required
+    // inversion operations.
     
     // Returns *this + other.
-    ProxyInterval operator+(const ProxyInterval& other) {
-        ProxyInterval temp;
-        
-        temp.data_ = data_ + other.data_;
-        temp.addr_ = controller.add(addr_, other.addr_);
-        
-        return temp;
+    ProxyInterval operator+(const ProxyInterval& other) const {
+        return at(get_controller<IntervalT>().add(addr(), other.addr()));
     }
     
     // Returns *this - other.
-    ProxyInterval operator-(const ProxyInterval& other) {
-        ProxyInterval temp;
-        
-        temp.data_ = data_ - other.data_;
-        temp.addr_ = controller.sub(addr_, other.addr_);
-        
-        return temp;
+    ProxyInterval operator-(const ProxyInterval& other) const {
+        return at(get_controller<IntervalT>().sub(addr(), other.addr()));
     }
     
     // Returns -*this.
-    ProxyInterval operator-() {
-        ProxyInterval temp;
-        temp = ProxyInterval(ArbInterval(0)) - *this;
-        return temp;
+    ProxyInterval operator-() const {
+        return ProxyInterval(IntervalT(0)) - *this;
     }
     
     // Returns *this * other.
-    ProxyInterval operator*(const ProxyInterval& other) {
-        ProxyInterval temp;
-        
-        temp.data_ = data_ * other.data_;
-        temp.addr_ = controller.mul(addr_, other.addr_);
-        
-        return temp;
+    ProxyInterval operator*(const ProxyInterval& other) const {
+        return at(get_controller<IntervalT>().mul(addr(), other.addr()));
     }
     
     // Returns *this / other.
-    ProxyInterval operator/(const ProxyInterval& other) {
-        ProxyInterval temp;
+    ProxyInterval operator/(const ProxyInterval& other) const {
+        return at(get_controller<IntervalT>().div(addr(), other.addr()));
+    }
+    
+    // Returns a * b + c recorded as one operation.
+    friend ProxyInterval fma(const ProxyInterval& a, const ProxyInterval& b,
+            const ProxyInterval& c) {
+        return dot(c.addr(), false, std::vector<size_t>(1, a.addr()),
+                   std::vector<size_t>(1, b.addr()));
+    }
+    
+    // Returns c - a * b recorded as one operation.
+    friend ProxyInterval fms(const ProxyInterval& a, const ProxyInterval& b,
+            const ProxyInterval& c) {
+        return dot(c.addr(), true, std::vector<size_t>(1, a.addr()),
+                   std::vector<size_t>(1, b.addr()));
+    }
+    
+    // Returns x[0] * y[0] + ... + x[n - 1] * y[n - 1] recorded as
+    // one operation.
+    friend ProxyInterval dot(const std::vector<ProxyInterval>& x,
+            const std::vector<ProxyInterval>& y) {
+        std::vector<size_t> a;
+        std::vector<size_t> b;
+        for (size_t i = 0; i < x.size(); ++i) {
+            a.push_back(x[i].addr());
+            b.push_back(y[i].addr());
+        }
         
-        temp.data_ = data_ / other.data_;
-        temp.addr_ = controller.div(addr_, other.addr_);
+        return dot(Controller<IntervalT>::kNone, false, a, b);
+    }
+    
+    // Compound assignments. Each of them records the same commands
+    // as the corresponding arithmetical operation.
+    ProxyInterval& operator+=(const ProxyInterval& other) {
+        return *this = *this + other;
+    }
+    
+    ProxyInterval& operator-=(const ProxyInterval& other) {
+        return *this = *this - other;
+    }
+    
+    ProxyInterval& operator*=(const ProxyInterval& other) {
+        return *this = *this * other;
+    }
+    
+    ProxyInterval& operator/=(const ProxyInterval& other) {
+        return *this = *this / other;
+    }
+    
+    // Returns the value in controller memory. The reference is valid
+    // until the next value is pushed to controller and the value is lost
+    // when the controller is cleared (e.g. by evaluate()).
+    const IntervalT& data() const {
+        static const IntervalT zero(0);
+        if (addr_ == kZero) {
+            return zero;
+        }
         
-        return temp;
+        return get_controller<IntervalT>().value(addr_);
+    }
+    
+    // Returns ProxyInterval address in controller object.
+    size_t addr() const {
+        if (addr_ == kZero) {
+            addr_ = get_controller<IntervalT>().push_value(IntervalT(0));
+        }
+        
+        return addr_;
     }
     
-    // Returns internal ProxyInterval data.
-    IntervalT data() const { return data_; }
+    // Functions used for pivot selection.
+    bool contains_zero() const { return data().contains_zero(); }
+    Value abs_ubound() const { return data().abs_ubound(); }
+    Magnitude mag() const { return data().mag(); }
     
 private:
-    IntervalT data_;
-    size_t addr_;
+    // Address of zero which is not pushed yet.
+    static const size_t kZero = static_cast<size_t>(-1);
+    
+    // ProxyInterval is only an address in controller memory, the value
+    // is stored and computed once by controller.
+    mutable size_t addr_;
+    
+    // Records dot product operation, see Controller::dot().
+    static ProxyInterval dot(size_t initial, bool subtract,
+            const std::vector<size_t>& x, const std::vector<size_t>& y) {
+        return at(get_controller<IntervalT>().dot(initial, subtract, x, y));
+    }
 };
 
 
+// Records the pivot choice of find_pivot() for matrix of ProxyInterval
+// values, so that replayed Program can detect a different one.
+template<class IntervalT>
+void on_pivot(const Matrix<ProxyInterval<IntervalT>>& matrix,
+        const int* rows, size_t count, size_t c, int pivot) {
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < count; ++i) {
+        candidates.push_back(matrix.at(rows[i], c).addr());
+    }
+    
+    get_controller<IntervalT>().push_pivot(candidates, pivot);
+}
+
+
 // Proxy object for result value. Performs all computations for 
 // error improvement of equated value.
 class ProxyIntervalResult {
 public:
+    ProxyIntervalResult() {}
+    
+    // data - traditionally computed value, result - the same value with
+    // apost computed error, rigorous - result is an enclosure.
+    ProxyIntervalResult(const ArbInterval& data, const ArbInterval& result,
+            bool rigorous = true)
+    : result_(result)
+    , data_(data)
+    , rigorous_(rigorous) {
+    }
 
     // Sets ProxyIntervalResult = evaluated value of ProxyInterval<ArbInterval>
     ProxyIntervalResult& operator=(const ProxyInterval<ArbInterval>& other) {
-        Controller<ArbInterval> temp = controller;
-        result_ = controller.evaluate();
-        controller = temp;
-        
-        data_ = other.data();
+        result_ = get_controller<ArbInterval>().evaluate(
+            std::vector<size_t>(1, other.addr()))[0];
+        data_ = traditional(other, result_);
+        rigorous_ = is_rigorous();
         
         return *this;
     }
@@ -412,25 +1375,80 @@ public:
     ProxyIntervalResult& operator=(const ProxyIntervalResult& other) {
         result_ = other.result_;
         data_ = other.data_;
+        rigorous_ = other.rigorous_;
         
         return *this;
     }
     
-    // Simple interval (ArbInterval) cast operator.
+    // Simple interval (ArbInterval) cast operator. It is an enclosure
+    // only if rigorous() is true.
     operator ArbInterval() const {
         if (result_.error() > data_.error()) return data_;
         return result_;
     }
     
+    // Returns false for results of kMidpointForward controllers: their
+    // errors are first order estimates.
+    bool rigorous() const { return rigorous_; }
+    
+    // Returns traditionally computed value of x. In kMidpointForward
+    // it is not computed: the midpoint with infinite radius is returned.
+    static ArbInterval traditional(const ProxyInterval<ArbInterval>& x,
+            const ArbInterval& result) {
+        if (!is_rigorous()) {
+            ArbInterval data(result.val());
+            mag_inf(arb_radref(data.data()));
+            return data;
+        }
+        
+        return x.data();
+    }
+    
+    // Returns true if results of the current controller are enclosures.
+    static bool is_rigorous() {
+        return get_controller<ArbInterval>().forward() !=
+            Controller<ArbInterval>::kMidpointForward;
+    }
+    
 private:
     ArbInterval result_;
     ArbInterval data_;
+    bool rigorous_ = true;
 };
 
+// Evaluates all values of matrix as output values. Errors of all
+// of them are computed in one reverse pass.
+inline Matrix<ProxyIntervalResult> evaluate(
+        const Matrix<ProxyInterval<ArbInterval>>& values) {
+    std::vector<size_t> outputs;
+    for (size_t i = 0; i < values.nrow(); ++i) {
+        for (size_t j = 0; j < values.ncol(); ++j) {
+            outputs.push_back(values.at(i, j).addr());
+        }
+    }
+    
+    std::vector<ArbInterval> results =
+        get_controller<ArbInterval>().evaluate(outputs);
+    
+    Matrix<ProxyIntervalResult> x(values.nrow(), values.ncol());
+    for (size_t i = 0; i < values.nrow(); ++i) {
+        for (size_t j = 0; j < values.ncol(); ++j) {
+            const ArbInterval& result = results[i * values.ncol() + j];
+            x.at(i, j) = ProxyIntervalResult(
+                ProxyIntervalResult::traditional(values.at(i, j), result),
+                result, ProxyIntervalResult::is_rigorous());
+        }
+    }
+    
+    return x;
+}
+
 }  // namespace apost
 
 }  // namespace interval
 
+// Matrix level nodes.
+#include "apost_matrix.h"
 
 #endif  // APOST_H
 
@@ -37,7 +37,8 @@ namespace interval {
 
 
 namespace apost {
-Matrix<ProxyIntervalResult> detsGauss(Matrix<ProxyInterval<ArbInterval>> matrix) {
+inline Matrix<ProxyIntervalResult> detsGauss(
+        Matrix<ProxyInterval<ArbInterval>> matrix) {
     size_t n = matrix.nrow();
     
     Matrix<ProxyInterval<ArbInterval>> L(n, n);
@@ -62,8 +63,7 @@ Matrix<ProxyIntervalResult> detsGauss(Matrix<ProxyInterval<ArbInterval>> matrix)
             L.at(j, i) = z;
             
             for (size_t k = i + 1; k < n; ++k) {
-                ProxyInterval<ArbInterval> t = matrix.at(i, k) * z;
-                matrix.at(j, k) = matrix.at(j, k) + t;
+                matrix.at(j, k) = fma(matrix.at(i, k), z, matrix.at(j, k));
                 L.at(j, k) = matrix.at(j, k);
             }
         }
@@ -72,8 +72,7 @@ Matrix<ProxyIntervalResult> detsGauss(Matrix<ProxyInterval<ArbInterval>> matrix)
     for (size_t k = 0; k < n; ++k)
 		for (size_t i = k + 1; i < n; ++i)
 			for (size_t j = i + 1; j < n; ++j) {
-			    ProxyInterval<ArbInterval> t = L.at(i, k) * matrix.at(j, i);
-			    L.at(j, k) = L.at(j, k) + t;
+			    L.at(j, k) = fma(L.at(i, k), matrix.at(j, i), L.at(j, k));
 			}
 			
     Matrix<ProxyIntervalResult> L2(n, n);
@@ -0,0 +1,385 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+
+#ifndef APOST_MATRIX_H
+#define APOST_MATRIX_H
+
+#include "apost.h"
+#include "crout.h"
+#include "gauss.h"
+#include "interval.h"
+#include "matrix.h"
+
+#include <memory>
+#include <vector>
+
+/*
+    This file contains matrix level Controller nodes.
+
+    Gaussian elimination of Matrix<ProxyInterval> values records about n^3
+    scalar operations (three commands and one memory element each). Here
+    it is computed on plain intervals and recorded as one LU node with n*m
+    outputs, back substitution - as one triangular solve node. Their
+    reverse steps use closed-form matrix formulas (as GaussInverse() of
+    statical method does), so the tape has O(n^2) elements.
+
+    For n*m matrix A (pivot rows order, m >= n) LU node outputs are
+        L - strictly lower part (unit diagonal is not stored),
+        U - upper part of the first n columns,
+        C = L^-1 A2 - the last m - n columns,
+    where A1 = L U is the first n columns of A and A2 is the rest. Reverse
+    step for output adjoints (Lb, Ub, Cb):
+        A2b = L^-T Cb,
+        Lb = Lb - stril(A2b C^T),
+        A1b = L^-T (stril(L^T Lb) + triu(Ub U^T)) U^-T.
+*/
+
+namespace interval {
+
+namespace apost {
+
+// Sets rows of x to L^-T x, where L is strictly lower part of lu
+// (with unit diagonal). x is n*k row-major.
+template<class IntervalT>
+void solve_unit_lower_transposed(const IntervalT* lu, size_t m, size_t n,
+        IntervalT* x, size_t k) {
+    for (size_t i = n; i-- > 0; ) {
+        for (size_t r = i + 1; r < n; ++r) {
+            const IntervalT& l = lu[r * m + i];
+            for (size_t j = 0; j < k; ++j) {
+                x[i * k + j].submul(l, x[r * k + j]);
+            }
+        }
+    }
+}
+
+// LU factorization node of n*m matrix.
+template<class IntervalT>
+class LUNode : public Node<IntervalT> {
+public:
+    // inputs - addresses of matrix elements in pivot rows order (i-th
+    // row is row perm[i] of matrix), perm is empty without pivoting.
+    LUNode(const std::vector<size_t>& inputs, size_t n, size_t m,
+            const std::vector<int>& perm)
+    : Node<IntervalT>(inputs, n * m)
+    , n_(n)
+    , m_(m)
+    , perm_(perm) {
+    }
+
+    bool forward(const IntervalT* const* inputs, IntervalT* outputs) const {
+        Matrix<IntervalT> a(n_, m_);
+        for (size_t i = 0; i < n_; ++i) {
+            size_t row = perm_.empty() ? i : perm_[i];
+            for (size_t j = 0; j < m_; ++j) {
+                a.at(row, j) = *inputs[i * m_ + j];
+            }
+        }
+
+        std::vector<int> perm;
+        if (perm_.empty()) {
+            gauss_elimination(a);
+        } else {
+            gauss_elimination_pivot(a, perm);
+            if (perm != perm_) {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < n_; ++i) {
+            size_t row = perm_.empty() ? i : perm_[i];
+            for (size_t j = 0; j < m_; ++j) {
+                outputs[i * m_ + j] = a.at(row, j);
+            }
+        }
+
+        return true;
+    }
+
+    void reverse(const IntervalT* const*, const IntervalT* outputs,
+            const IntervalT* output_adjoints,
+            IntervalT* input_adjoints) const {
+        const IntervalT* lu = outputs;
+        size_t n = n_;
+        size_t m = m_;
+        size_t k = m - n;
+
+        // b - output adjoints, becomes input adjoints
+        IntervalT* b = input_adjoints;
+        for (size_t i = 0; i < n * m; ++i) {
+            b[i] = output_adjoints[i];
+        }
+
+        // A2b = L^-T Cb
+        std::vector<IntervalT> x(n * k);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < k; ++j) {
+                x[i * k + j] = b[i * m + n + j];
+            }
+        }
+        solve_unit_lower_transposed(lu, m, n, x.data(), k);
+
+        // Lb = Lb - stril(A2b C^T)
+        for (size_t i = 1; i < n; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                for (size_t c = 0; c < k; ++c) {
+                    b[i * m + j].submul(x[i * k + c], lu[j * m + n + c]);
+                }
+            }
+        }
+
+        // g = stril(L^T Lb) + triu(Ub U^T)
+        std::vector<IntervalT> g(n * n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                IntervalT& y = g[i * n + j];
+                if (i > j) {
+                    y = b[i * m + j];
+                    for (size_t r = i + 1; r < n; ++r) {
+                        y.addmul(lu[r * m + i], b[r * m + j]);
+                    }
+                } else {
+                    for (size_t r = j; r < n; ++r) {
+                        y.addmul(b[i * m + r], lu[j * m + r]);
+                    }
+                }
+            }
+        }
+
+        // g = g U^-T
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = n; j-- > 0; ) {
+                IntervalT& y = g[i * n + j];
+                for (size_t r = j + 1; r < n; ++r) {
+                    y.submul(lu[j * m + r], g[i * n + r]);
+                }
+                y /= lu[j * m + j];
+            }
+        }
+
+        // A1b = L^-T g
+        solve_unit_lower_transposed(lu, m, n, g.data(), n);
+
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                b[i * m + j] = g[i * n + j];
+            }
+            for (size_t j = 0; j < k; ++j) {
+                b[i * m + n + j] = x[i * k + j];
+            }
+        }
+    }
+
+private:
+    size_t n_;
+    size_t m_;
+    std::vector<int> perm_;
+};
+
+// Back substitution node: solves U x = C, where U is n*n upper triangular
+// part and C is the last k = m - n columns of n*m matrix (LU node
+// outputs). Inputs are U elements by rows, then C elements, outputs
+// are n*k elements of x.
+template<class IntervalT>
+class TriangularSolveNode : public Node<IntervalT> {
+public:
+    TriangularSolveNode(const std::vector<size_t>& inputs, size_t n, size_t k)
+    : Node<IntervalT>(inputs, n * k)
+    , n_(n)
+    , k_(k) {
+    }
+
+    // Computes x = U^-1 C, u and c - n*n and n*k row-major matrices.
+    static void solve(const IntervalT* u, const IntervalT* c, size_t n,
+            size_t k, IntervalT* x) {
+        for (size_t i = n; i-- > 0; ) {
+            for (size_t j = 0; j < k; ++j) {
+                IntervalT& y = x[i * k + j];
+                y = c[i * k + j];
+                for (size_t r = i + 1; r < n; ++r) {
+                    y.submul(u[i * n + r], x[r * k + j]);
+                }
+                y /= u[i * n + i];
+            }
+        }
+    }
+
+    bool forward(const IntervalT* const* inputs, IntervalT* outputs) const {
+        std::vector<IntervalT> a(this->inputs().size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            a[i] = *inputs[i];
+        }
+
+        solve(a.data(), a.data() + n_ * n_, n_, k_, outputs);
+
+        return true;
+    }
+
+    // Cb = U^-T xb, Ub = -triu(Cb x^T).
+    void reverse(const IntervalT* const* inputs, const IntervalT* outputs,
+            const IntervalT* output_adjoints,
+            IntervalT* input_adjoints) const {
+        const IntervalT* x = outputs;
+        size_t n = n_;
+        size_t k = k_;
+
+        auto u = [&] (size_t i, size_t j) -> const IntervalT& {
+            return *inputs[i * n + j];
+        };
+
+        IntervalT* ub = input_adjoints;
+        IntervalT* cb = input_adjoints + n * n;
+
+        // U^T cb = xb, forward substitution
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < k; ++j) {
+                IntervalT& y = cb[i * k + j];
+                y = output_adjoints[i * k + j];
+                for (size_t r = 0; r < i; ++r) {
+                    y.submul(u(r, i), cb[r * k + j]);
+                }
+                y /= u(i, i);
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                IntervalT& y = ub[i * n + j];
+                y.zero();
+                if (j < i) {
+                    continue;
+                }
+                for (size_t c = 0; c < k; ++c) {
+                    y.submul(cb[i * k + c], x[j * k + c]);
+                }
+            }
+        }
+    }
+
+private:
+    size_t n_;
+    size_t k_;
+};
+
+// Factorizes n*m matrix of ProxyInterval values as one LU node. If perm is
+// not null, pivoting is used and rows are not moved (as in
+// gauss_elimination_pivot()). Returns (-1)^(number of permutations).
+template<class IntervalT>
+int lu_node(Matrix<ProxyInterval<IntervalT>>& matrix, std::vector<int>* perm) {
+    Controller<IntervalT>& controller = get_controller<IntervalT>();
+    PrecisionScope scope(controller.precision());
+
+    size_t n = matrix.nrow();
+    size_t m = matrix.ncol();
+
+    // values of controller memory (points in kMidpointForward)
+    Matrix<IntervalT> a(n, m);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            a.at(i, j) = controller.value(matrix.at(i, j).addr());
+        }
+    }
+
+    int sign = 1;
+    std::vector<int> rows;
+    if (perm) {
+        sign = gauss_elimination_pivot(a, rows);
+    } else {
+        gauss_elimination(a);
+    }
+
+    std::vector<size_t> inputs(n * m);
+    std::vector<IntervalT> outputs(n * m);
+    for (size_t i = 0; i < n; ++i) {
+        size_t row = perm ? rows[i] : i;
+        for (size_t j = 0; j < m; ++j) {
+            inputs[i * m + j] = matrix.at(row, j).addr();
+            outputs[i * m + j] = a.at(row, j);
+        }
+    }
+
+    size_t first = controller.push_node(
+        std::make_shared<LUNode<IntervalT>>(inputs, n, m, rows), outputs);
+
+    for (size_t i = 0; i < n; ++i) {
+        size_t row = perm ? rows[i] : i;
+        for (size_t j = 0; j < m; ++j) {
+            matrix.at(row, j) = ProxyInterval<IntervalT>::at(first + i * m + j);
+        }
+    }
+
+    if (perm) {
+        perm->swap(rows);
+    }
+
+    return sign;
+}
+
+}  // namespace apost
+
+// Matrix<ProxyInterval> versions of gauss.h functions. Elimination is
+// recorded as one LU node, see above.
+template<class IntervalT>
+void gauss_elimination(Matrix<apost::ProxyInterval<IntervalT>>& matrix) {
+    apost::lu_node(matrix, nullptr);
+}
+
+template<class IntervalT>
+int gauss_elimination_pivot(Matrix<apost::ProxyInterval<IntervalT>>& matrix,
+        std::vector<int>& perm) {
+    return apost::lu_node(matrix, &perm);
+}
+
+// Matrix<ProxyInterval> version of back_substitution() (leqs.h) recorded
+// as one triangular solve node.
+template<class IntervalT>
+Matrix<apost::ProxyInterval<IntervalT>> back_substitution(
+        const Matrix<apost::ProxyInterval<IntervalT>>& M) {
+    using apost::ProxyInterval;
+
+    apost::Controller<IntervalT>& controller =
+        apost::get_controller<IntervalT>();
+    PrecisionScope scope(controller.precision());
+
+    size_t n = M.nrow();
+    size_t k = M.ncol() - n;
+
+    std::vector<size_t> inputs;
+    std::vector<IntervalT> a;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            inputs.push_back(M.at(i, j).addr());
+            a.push_back(controller.value(M.at(i, j).addr()));
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < k; ++j) {
+            inputs.push_back(M.at(i, n + j).addr());
+            a.push_back(controller.value(M.at(i, n + j).addr()));
+        }
+    }
+
+    std::vector<IntervalT> x(n * k);
+    apost::TriangularSolveNode<IntervalT>::solve(a.data(), a.data() + n * n,
+                                                 n, k, x.data());
+
+    size_t first = controller.push_node(
+        std::make_shared<apost::TriangularSolveNode<IntervalT>>(inputs, n, k),
+        x);
+
+    Matrix<ProxyInterval<IntervalT>> result(n, k);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < k; ++j) {
+            result.at(i, j) = ProxyInterval<IntervalT>::at(first + i * k + j);
+        }
+    }
+
+    return result;
+}
+
+}  // namespace interval
+
+#endif  // APOST_MATRIX_H
@@ -0,0 +1,811 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+#ifndef APOST_PROGRAM_H
+#define APOST_PROGRAM_H
+
+#include "apost.h"
+#include "gauss.h"
+#include "interval.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+    This file contains Program class - recorded Controller computations
+    frozen for reuse.
+
+    The same computation (e.g. determinant of n*n matrix) is often performed
+    on a stream of inputs. Program is recorded once using ProxyInterval
+    values and then it can be replayed with new input values: forward for
+    the output value and backward for its apost error. Replay works on plain
+    intervals, there is no ProxyInterval dispatch and no commands recording.
+
+    Pivot choices depend on data, so Program checks every recorded pivot
+    choice during replay and reports a mismatch. replay_or_record() then
+    records the computation again.
+
+    Replay memory is bounded by set_budget(): only snapshots of the forward
+    pass are kept and its segments are recomputed during the reverse pass.
+    Operations of the program are a few words each, the interval values
+    are the most of replay memory at high precision.
+*/
+
+namespace interval {
+
+namespace apost {
+
+template<class IntervalT>
+class Program {
+public:
+    Program()
+    : ninputs_(0), output_(0), precision_(0), budget_(0), max_state_(0) {}
+
+    // Freezes computations recorded by controller since the last evaluate().
+    // output - address of output value.
+    // Controller data is not changed. Constants of kMidpointForward
+    // controllers are points (their radii are in the reverse commands),
+    // so their programs are empty and replay_or_record() records again.
+    Program(const Controller<IntervalT>& controller, size_t output)
+    : ops_(controller.ops_.begin(),
+           controller.ops_.begin() + node_end(controller, output))
+    , nodes_(controller.nodes_)
+    , operands_(controller.operands_)
+    , guard_addrs_(controller.guard_addrs_)
+    , ninputs_(controller.ninputs_)
+    , output_(output)
+    , precision_(controller.precision_)
+    , budget_(0)
+    , max_state_(0) {
+        if (controller.forward() == Controller<IntervalT>::kMidpointForward) {
+            *this = Program();
+            return;
+        }
+        
+        for (size_t i = ninputs_; i <= output_; ++i) {
+            if (ops_[i].kind == Controller<IntervalT>::kValue) {
+                ops_[i].a = constants_.size();
+                constants_.push_back(controller.memory_[i]);
+            }
+        }
+
+        for (const auto& guard : controller.guards_) {
+            if (guard.position <= output_) {
+                guards_.push_back(guard);
+            }
+        }
+        
+        find_live();
+    }
+
+    // Returns true if there is no recorded computations.
+    bool empty() const { return ops_.empty(); }
+
+    // Number of input values.
+    size_t ninputs() const { return ninputs_; }
+
+    // Sets the memory budget of evaluate(): the number of intervals
+    // (values, adjoints and snapshots of the forward pass) stored at once.
+    // 0 (default) means no limit. If the program is larger, evaluate()
+    // keeps only snapshots of the forward pass and recomputes its segments
+    // during the reverse pass (see sweep()). Temporaries of one node step
+    // are not counted.
+    void set_budget(size_t budget) {
+        budget_ = budget;
+        if (budget_ != 0 && state_sizes_.empty()) {
+            find_deaths();
+        }
+    }
+
+    size_t budget() const { return budget_; }
+
+    // Results of evaluate().
+    enum Status {
+        kEvaluated,
+        // some pivot choice differs from the recorded one
+        kPivotChanged,
+        // the budget is less than the least memory of the schedule
+        kOverBudget,
+        // the number of inputs differs from ninputs()
+        kWrongInputs
+    };
+
+    // Replays the program with new input values. On success stores the
+    // output value with apost computed error to result and returns
+    // kEvaluated.
+    Status evaluate(const std::vector<IntervalT>& inputs,
+            IntervalT& result) const {
+        PrecisionScope scope(precision_);
+        size_t n = ops_.size();
+        if (inputs.size() != ninputs_) {
+            return kWrongInputs;
+        }
+        if (budget_ != 0 && budget_ < max_state_) {
+            return kOverBudget;
+        }
+
+        Memory memory(n, budget_);
+        IntervalT* adjoint = memory.get(Memory::kAdjoints, output_);
+        if (!adjoint) {
+            return kOverBudget;
+        }
+        *adjoint = 1;
+
+        IntervalT output;
+        Status status = sweep(inputs, memory, output, 0, n);
+        if (status != kEvaluated) {
+            return status;
+        }
+
+        // error = sum |adjoint of x| * (err of x) over input values
+        IntervalT error = 0;
+        for (size_t i = 0; i < ninputs_; ++i) {
+            IntervalT* x = memory.find(Memory::kAdjoints, i);
+            if (x) {
+                x->abs();
+                error.addmul(*x, IntervalT(inputs[i].error()));
+            }
+        }
+
+        result = IntervalT(output.val(), error.val() + error.error());
+
+        return kEvaluated;
+    }
+
+private:
+    typedef typename Controller<IntervalT>::Operation Operation;
+    typedef typename Controller<IntervalT>::Guard Guard;
+
+    std::vector<Operation> ops_;
+    std::vector<std::shared_ptr<const Node<IntervalT>>> nodes_;
+    std::vector<size_t> operands_;
+    std::vector<IntervalT> constants_;
+    std::vector<Guard> guards_;
+    std::vector<size_t> guard_addrs_;
+    // operations the output depends on, others are skipped by reverse pass
+    std::vector<bool> live_;
+    size_t ninputs_;
+    size_t output_;
+    int precision_;
+
+    // checkpointed evaluate() data, see sweep()
+    size_t budget_;
+    std::vector<size_t> death_first_;
+    std::vector<size_t> death_addrs_;
+    std::vector<size_t> state_sizes_;
+    size_t max_state_;
+
+    // Values and adjoints of evaluate() by address. At most limit of them
+    // (0 - no limit) are stored at once, snapshots included. With a limit
+    // addresses are found by hash tables, so the memory is proportional
+    // to the number of stored intervals, not to the program size.
+    class Memory {
+    public:
+        enum Kind { kValues, kAdjoints };
+
+        // Slot of absent interval.
+        static const size_t kAbsent = static_cast<size_t>(-1);
+
+        Memory(size_t n, size_t limit)
+        : limit_(limit)
+        , size_(0) {
+            // at most n values and n adjoints are stored, slots are not
+            // moved, so returned pointers are valid until release
+            pool_.reserve(limit == 0 ? 2 * n : std::min(limit, 2 * n));
+            if (limit == 0) {
+                dense_[kValues].assign(n, kAbsent);
+                dense_[kAdjoints].assign(n, kAbsent);
+            }
+        }
+
+        // Number of stored intervals.
+        size_t size() const { return size_; }
+
+        // Returns stored interval or null.
+        IntervalT* find(Kind kind, size_t addr) {
+            size_t slot = find_slot(kind, addr);
+            return slot == kAbsent ? nullptr : &pool_[slot];
+        }
+
+        // Returns stored value, it must be present.
+        const IntervalT& operator[](size_t addr) const {
+            return pool_[find_slot(kValues, addr)];
+        }
+
+        // Returns stored interval, a zero one is stored if it is absent.
+        // Returns null if the limit is reached.
+        IntervalT* get(Kind kind, size_t addr) {
+            size_t slot = find_slot(kind, addr);
+            if (slot == kAbsent) {
+                slot = allocate();
+                if (slot == kAbsent) {
+                    return nullptr;
+                }
+                set_slot(kind, addr, slot);
+            }
+
+            return &pool_[slot];
+        }
+
+        // Removes interval from the addresses and returns its slot (or
+        // kAbsent). It is stored until attach() or free().
+        size_t take(Kind kind, size_t addr) {
+            size_t slot = find_slot(kind, addr);
+            if (slot != kAbsent) {
+                set_slot(kind, addr, kAbsent);
+            }
+
+            return slot;
+        }
+
+        void attach(Kind kind, size_t addr, size_t slot) {
+            set_slot(kind, addr, slot);
+        }
+
+        IntervalT& at(size_t slot) { return pool_[slot]; }
+
+        // Frees the slot and the memory of its interval.
+        void free(size_t slot) {
+            IntervalT().swap(pool_[slot]);
+            free_.push_back(slot);
+            --size_;
+        }
+
+        void release(Kind kind, size_t addr) {
+            size_t slot = take(kind, addr);
+            if (slot != kAbsent) {
+                free(slot);
+            }
+        }
+
+    private:
+        size_t limit_;
+        size_t size_;
+        std::vector<IntervalT> pool_;
+        std::vector<size_t> free_;
+        std::vector<size_t> dense_[2];
+        std::unordered_map<size_t, size_t> sparse_[2];
+
+        size_t allocate() {
+            if (limit_ != 0 && size_ == limit_) {
+                return kAbsent;
+            }
+
+            ++size_;
+            if (!free_.empty()) {
+                size_t slot = free_.back();
+                free_.pop_back();
+                return slot;
+            }
+            pool_.emplace_back();
+            return pool_.size() - 1;
+        }
+
+        size_t find_slot(Kind kind, size_t addr) const {
+            if (limit_ == 0) {
+                return dense_[kind][addr];
+            }
+
+            auto it = sparse_[kind].find(addr);
+            return it == sparse_[kind].end() ? kAbsent : it->second;
+        }
+
+        void set_slot(Kind kind, size_t addr, size_t slot) {
+            if (limit_ == 0) {
+                dense_[kind][addr] = slot;
+            } else if (slot == kAbsent) {
+                sparse_[kind].erase(addr);
+            } else {
+                sparse_[kind][addr] = slot;
+            }
+        }
+    };
+
+    // Returns the end of recorded operations for output address: if output
+    // is a node output, all outputs of the node are included.
+    static size_t node_end(const Controller<IntervalT>& controller,
+            size_t output) {
+        size_t end = output + 1;
+        while (end < controller.ops_.size() &&
+               controller.ops_[end].kind == Controller<IntervalT>::kNodeOutput &&
+               controller.ops_[end].b != 0) {
+            ++end;
+        }
+
+        return end;
+    }
+
+    // Values of the forward pass which are kept by sweep(): address
+    // and memory slot.
+    typedef std::vector<std::pair<size_t, size_t>> Snapshot;
+
+    // Computes operations [p, q) to memory, the output value is copied
+    // to output. Checks pivot choices made before them. If snapshot is not
+    // null, values are released after their last use, values before p
+    // are moved to snapshot.
+    Status forward(const std::vector<IntervalT>& inputs, Memory& memory,
+            IntervalT& output, size_t p, size_t q, Snapshot* snapshot) const {
+        auto g = std::lower_bound(guards_.begin(), guards_.end(), p,
+            [] (const Guard& guard, size_t i) { return guard.position < i; });
+
+        for (size_t i = p; i < q; ++i) {
+            for (; g != guards_.end() && g->position == i; ++g) {
+                if (!check(*g, memory)) {
+                    return kPivotChanged;
+                }
+            }
+
+            Status status = compute(i, inputs, memory);
+            if (status != kEvaluated) {
+                return status;
+            }
+            if (i == output_) {
+                output = memory[i];
+            }
+
+            for (size_t d = snapshot ? death_first_[i] : 0;
+                    snapshot && d < death_first_[i + 1]; ++d) {
+                size_t v = death_addrs_[d];
+                if (v < p) {
+                    snapshot->emplace_back(v,
+                        memory.take(Memory::kValues, v));
+                } else {
+                    memory.release(Memory::kValues, v);
+                }
+            }
+        }
+
+        return kEvaluated;
+    }
+
+    // Computes i-th operation.
+    Status compute(size_t i, const std::vector<IntervalT>& inputs,
+            Memory& memory) const {
+        const Operation& op = ops_[i];
+        IntervalT x;
+        switch (op.kind) {
+        case Controller<IntervalT>::kValue:
+            x = i < ninputs_ ? inputs[i] : constants_[op.a];
+            break;
+        case Controller<IntervalT>::kAdd:
+            x = memory[op.a] + memory[op.b];
+            break;
+        case Controller<IntervalT>::kSub:
+            x = memory[op.a] - memory[op.b];
+            break;
+        case Controller<IntervalT>::kMul:
+            x = memory[op.a] * memory[op.b];
+            break;
+        case Controller<IntervalT>::kDiv:
+            x = memory[op.a] / memory[op.b];
+            break;
+        case Controller<IntervalT>::kDot:
+        case Controller<IntervalT>::kDotSub: {
+            size_t initial = operands_[op.a];
+            x = dot(
+                initial == Controller<IntervalT>::kNone ?
+                    nullptr : &memory[initial],
+                op.kind == Controller<IntervalT>::kDotSub,
+                memory, &operands_[op.a + 1], op.b);
+            break;
+        }
+        case Controller<IntervalT>::kNodeOutput:
+            // the first output computes all of them
+            return op.b == 0 ? forward_node(i, memory) : kEvaluated;
+        }
+
+        IntervalT* y = memory.get(Memory::kValues, i);
+        if (!y) {
+            return kOverBudget;
+        }
+        y->swap(x);
+
+        return kEvaluated;
+    }
+
+    // Computes outputs of node with the first output at i.
+    Status forward_node(size_t i, Memory& memory) const {
+        const Node<IntervalT>& node = *nodes_[ops_[i].a];
+        const std::vector<size_t>& inputs = node.inputs();
+
+        std::vector<const IntervalT*> input_values(inputs.size());
+        for (size_t k = 0; k < inputs.size(); ++k) {
+            input_values[k] = &memory[inputs[k]];
+        }
+
+        std::vector<IntervalT> outputs(node.noutputs());
+        if (!node.forward(input_values.data(), outputs.data())) {
+            return kPivotChanged;
+        }
+
+        for (size_t k = 0; k < outputs.size(); ++k) {
+            IntervalT* y = memory.get(Memory::kValues, i + k);
+            if (!y) {
+                return kOverBudget;
+            }
+            y->swap(outputs[k]);
+        }
+
+        return kEvaluated;
+    }
+
+    // Reverse pass over operations [p, q), the same as
+    // Controller::evaluate() commands. Adjoints of operations are
+    // released after their reverse steps.
+    Status reverse(Memory& memory, size_t p, size_t q) const {
+        // adjoints which do not fit to the budget are added to spare
+        bool fits = true;
+        IntervalT spare;
+        auto adjoint = [&] (size_t addr) -> IntervalT& {
+            IntervalT* x = memory.get(Memory::kAdjoints, addr);
+            fits = fits && x;
+            return x ? *x : spare;
+        };
+
+        for (size_t i = q; i-- > std::max(p, ninputs_); ) {
+            if (!live_[i]) {
+                continue;
+            }
+
+            const Operation& op = ops_[i];
+
+            // node reverse step at its first output
+            if (op.kind == Controller<IntervalT>::kNodeOutput) {
+                if (op.b == 0 && !reverse_node(i, memory)) {
+                    return kOverBudget;
+                }
+                continue;
+            }
+
+            // zero adjoint
+            size_t slot = memory.take(Memory::kAdjoints, i);
+            if (slot == Memory::kAbsent) {
+                continue;
+            }
+
+            IntervalT s;
+            s.swap(memory.at(slot));
+            memory.free(slot);
+
+            switch (op.kind) {
+            case Controller<IntervalT>::kValue:
+            case Controller<IntervalT>::kNodeOutput:
+                break;
+            case Controller<IntervalT>::kAdd:
+                adjoint(op.a) += s;
+                adjoint(op.b) += s;
+                break;
+            case Controller<IntervalT>::kSub:
+                adjoint(op.a) += s;
+                adjoint(op.b) -= s;
+                break;
+            case Controller<IntervalT>::kMul:
+                adjoint(op.a).addmul(memory[op.b], s);
+                adjoint(op.b).addmul(memory[op.a], s);
+                break;
+            case Controller<IntervalT>::kDiv: {
+                IntervalT temp = -memory[op.a];
+                temp /= memory[op.b];
+                temp /= memory[op.b];
+
+                adjoint(op.a).addmul(IntervalT(1) / memory[op.b], s);
+                adjoint(op.b).addmul(temp, s);
+                break;
+            }
+            case Controller<IntervalT>::kDot:
+            case Controller<IntervalT>::kDotSub: {
+                size_t initial = operands_[op.a];
+                if (initial != Controller<IntervalT>::kNone) {
+                    adjoint(initial) += s;
+                }
+                if (op.kind == Controller<IntervalT>::kDotSub) {
+                    s.neg();
+                }
+                for (size_t k = 0; k < op.b; ++k) {
+                    size_t x = operands_[op.a + 1 + 2 * k];
+                    size_t y = operands_[op.a + 2 + 2 * k];
+                    adjoint(x).addmul(memory[y], s);
+                    adjoint(y).addmul(memory[x], s);
+                }
+                break;
+            }
+            }
+
+            if (!fits) {
+                return kOverBudget;
+            }
+        }
+
+        return kEvaluated;
+    }
+
+    // Reverse step of node with the first output at i. Its output values
+    // and adjoints are not used after it, they are moved out of memory.
+    // Returns false if input adjoints do not fit to the budget.
+    bool reverse_node(size_t i, Memory& memory) const {
+        const Node<IntervalT>& node = *nodes_[ops_[i].a];
+        const std::vector<size_t>& inputs = node.inputs();
+
+        std::vector<IntervalT> outputs(node.noutputs());
+        std::vector<IntervalT> output_adjoints(node.noutputs());
+        for (size_t k = 0; k < outputs.size(); ++k) {
+            outputs[k].swap(*memory.find(Memory::kValues, i + k));
+
+            size_t slot = memory.take(Memory::kAdjoints, i + k);
+            if (slot != Memory::kAbsent) {
+                output_adjoints[k].swap(memory.at(slot));
+                memory.free(slot);
+            }
+        }
+
+        std::vector<const IntervalT*> input_values(inputs.size());
+        for (size_t k = 0; k < inputs.size(); ++k) {
+            input_values[k] = &memory[inputs[k]];
+        }
+
+        std::vector<IntervalT> input_adjoints(inputs.size());
+        node.reverse(input_values.data(), outputs.data(),
+                     output_adjoints.data(), input_adjoints.data());
+
+        for (size_t k = 0; k < inputs.size(); ++k) {
+            IntervalT* x = memory.get(Memory::kAdjoints, inputs[k]);
+            if (!x) {
+                return false;
+            }
+            *x += input_adjoints[k];
+        }
+
+        return true;
+    }
+
+    /*
+        Checkpointed reverse pass over operations [p, q) (binary
+        checkpointing, a simple form of revolve schedule [1]).
+
+        The state at position p is the set of values before p which are
+        used at or after p, memory contains it. If the values and adjoints
+        of [p, q) fit to the budget with the stored intervals, the segment
+        is computed and reversed. Otherwise the state values which die in
+        [p, m) are kept in snapshot, forward pass goes to the middle m,
+        [m, q) is reversed recursively, the state at p is restored from
+        snapshot and [p, m) is reversed. Every operation is recomputed
+        O(log(n / budget)) times. A segment of one operation (or node) is
+        computed even if the estimate exceeds the budget, memory returns
+        kOverBudget if it does not fit. On return memory contains the state
+        at p again.
+
+            [1] Griewank, A., Walther, A., Algorithm 799: revolve, ACM
+                Transactions on Mathematical Software, Volume 26, 2000,
+                pp. 19-45.
+    */
+    Status sweep(const std::vector<IntervalT>& inputs, Memory& memory,
+            IntervalT& output, size_t p, size_t q) const {
+        // node outputs are not separated
+        size_t m = p + (q - p) / 2;
+        while (m < q && ops_[m].kind == Controller<IntervalT>::kNodeOutput &&
+               ops_[m].b != 0) {
+            ++m;
+        }
+
+        if (budget_ == 0 || m == p || m == q ||
+                memory.size() + 2 * (q - p) + state_sizes_[p] <= budget_) {
+            Status status = forward(inputs, memory, output, p, q, nullptr);
+            if (status == kEvaluated) {
+                status = reverse(memory, p, q);
+            }
+
+            for (size_t i = p; i < q; ++i) {
+                memory.release(Memory::kValues, i);
+            }
+            return status;
+        }
+
+        Snapshot snapshot;
+        Status status = forward(inputs, memory, output, p, m, &snapshot);
+        if (status == kEvaluated) {
+            status = sweep(inputs, memory, output, m, q);
+        }
+
+        // the state at p
+        for (size_t i = p; i < m; ++i) {
+            memory.release(Memory::kValues, i);
+        }
+        for (const auto& x : snapshot) {
+            memory.attach(Memory::kValues, x.first, x.second);
+        }
+
+        if (status != kEvaluated) {
+            return status;
+        }
+        return sweep(inputs, memory, output, p, m);
+    }
+
+    // Finds the last use of every value for sweep(): values which are
+    // last used by i-th operation (or by pivot choice before it) are
+    // death_addrs_[death_first_[i]], ..., death_addrs_[death_first_[i + 1] - 1].
+    // state_sizes_[p] is the number of values before p used at or after p,
+    // max_state_ is the least budget: the largest state with one value.
+    void find_deaths() {
+        size_t n = ops_.size();
+        std::vector<size_t> last_use(n);
+        for (size_t i = 0; i < n; ++i) {
+            last_use[i] = i;
+        }
+
+        for (size_t i = ninputs_; i < n; ++i) {
+            const Operation& op = ops_[i];
+            switch (op.kind) {
+            case Controller<IntervalT>::kValue:
+                break;
+            case Controller<IntervalT>::kAdd:
+            case Controller<IntervalT>::kSub:
+            case Controller<IntervalT>::kMul:
+            case Controller<IntervalT>::kDiv:
+                last_use[op.a] = i;
+                last_use[op.b] = i;
+                break;
+            case Controller<IntervalT>::kDot:
+            case Controller<IntervalT>::kDotSub: {
+                size_t initial = operands_[op.a];
+                if (initial != Controller<IntervalT>::kNone) {
+                    last_use[initial] = i;
+                }
+                for (size_t k = 0; k < 2 * op.b; ++k) {
+                    last_use[operands_[op.a + 1 + k]] = i;
+                }
+                break;
+            }
+            case Controller<IntervalT>::kNodeOutput:
+                if (op.b == 0) {
+                    for (size_t input : nodes_[op.a]->inputs()) {
+                        last_use[input] = i;
+                    }
+                }
+                break;
+            }
+        }
+
+        for (const Guard& guard : guards_) {
+            for (size_t k = 0; k < guard.count; ++k) {
+                size_t& last = last_use[guard_addrs_[guard.first + k]];
+                last = std::max(last, guard.position);
+            }
+        }
+
+        death_first_.assign(n + 1, 0);
+        for (size_t v = 0; v < n; ++v) {
+            ++death_first_[last_use[v] + 1];
+        }
+        state_sizes_.assign(n + 1, 0);
+        for (size_t i = 0; i < n; ++i) {
+            state_sizes_[i + 1] = state_sizes_[i] + 1 -
+                                  death_first_[i + 1];
+            death_first_[i + 1] += death_first_[i];
+            max_state_ = std::max(max_state_, state_sizes_[i] + 1);
+        }
+
+        death_addrs_.resize(n);
+        std::vector<size_t> next(death_first_.begin(), death_first_.end() - 1);
+        for (size_t v = 0; v < n; ++v) {
+            death_addrs_[next[last_use[v]]++] = v;
+        }
+    }
+
+    // Marks the output and operands of marked operations in live_.
+    // Outputs of a node are marked with its first output, the reverse
+    // step of the node is performed there.
+    void find_live() {
+        live_.assign(ops_.size(), false);
+        live_[output_] = true;
+
+        for (size_t i = ops_.size(); i-- > ninputs_; ) {
+            if (!live_[i]) {
+                continue;
+            }
+
+            const Operation& op = ops_[i];
+            switch (op.kind) {
+            case Controller<IntervalT>::kValue:
+                break;
+            case Controller<IntervalT>::kAdd:
+            case Controller<IntervalT>::kSub:
+            case Controller<IntervalT>::kMul:
+            case Controller<IntervalT>::kDiv:
+                live_[op.a] = true;
+                live_[op.b] = true;
+                break;
+            case Controller<IntervalT>::kDot:
+            case Controller<IntervalT>::kDotSub: {
+                size_t initial = operands_[op.a];
+                if (initial != Controller<IntervalT>::kNone) {
+                    live_[initial] = true;
+                }
+                for (size_t k = 0; k < 2 * op.b; ++k) {
+                    live_[operands_[op.a + 1 + k]] = true;
+                }
+                break;
+            }
+            case Controller<IntervalT>::kNodeOutput:
+                if (op.b != 0) {
+                    live_[i - op.b] = true;
+                } else {
+                    for (size_t input : nodes_[op.a]->inputs()) {
+                        live_[input] = true;
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    // Returns true if pivot choice on replayed values is the same
+    // as the recorded one.
+    bool check(const Guard& guard, const Memory& values) const {
+        const size_t* addrs = guard_addrs_.data() + guard.first;
+        int pivot = select_pivot(guard.count,
+            [&] (size_t i) -> const IntervalT& { return values[addrs[i]]; });
+
+        return pivot == guard.pivot;
+    }
+};
+
+template<class IntervalT>
+const size_t Program<IntervalT>::Memory::kAbsent;
+
+// Computes kernel output with apost error for inputs using program.
+// If program is empty or replay detects a different pivot choice, records
+// the kernel again into program (with the same budget). Other failures
+// of evaluate() are not fixed by recording: program is kept, [0 +/- inf]
+// is returned. If status is not null, it gets the result of evaluate().
+// kernel gets the vector of input ProxyInterval values and returns output
+// ProxyInterval value.
+template<class Kernel>
+ArbInterval replay_or_record(Program<ArbInterval>& program,
+        const std::vector<ArbInterval>& inputs, Kernel kernel,
+        Program<ArbInterval>::Status* status = nullptr) {
+    ArbInterval result;
+    Program<ArbInterval>::Status replayed = Program<ArbInterval>::kPivotChanged;
+    if (!program.empty()) {
+        replayed = program.evaluate(inputs, result);
+    }
+
+    if (replayed == Program<ArbInterval>::kPivotChanged) {
+        // the kernel is recorded by its own controller, only operations
+        Controller<ArbInterval> controller;
+        ControllerScope<ArbInterval> scope(controller);
+        controller.set_mode(Controller<ArbInterval>::kOpsMode);
+
+        std::vector<ProxyInterval<ArbInterval>> x;
+        for (const auto& input : inputs) {
+            x.push_back(ProxyInterval<ArbInterval>(input));
+        }
+        controller.init();
+
+        ProxyInterval<ArbInterval> y = kernel(x);
+        size_t budget = program.budget();
+        program = Program<ArbInterval>(controller, y.addr());
+        program.set_budget(budget);
+
+        replayed = program.evaluate(inputs, result);
+    }
+
+    if (replayed != Program<ArbInterval>::kEvaluated) {
+        result = ArbInterval(0, INFINITY);
+    }
+    if (status) {
+        *status = replayed;
+    }
+    return result;
+}
+
+}  // namespace apost
+
+}  // namespace interval
+
+#endif  // APOST_PROGRAM_H
@@ -9,10 +9,12 @@
 #include "interval.h"
 #include "matrix.h"
 
+#include <vector>
+
 namespace interval {
 
 // Computes the final error.
-Value ComputeError(const Matrix<ArbInterval>& A,
+inline Value ComputeError(const Matrix<ArbInterval>& A,
         const Matrix<ArbInterval>& dA) {
     size_t n = A.nrow();
     size_t m = A.ncol();
@@ -25,7 +27,7 @@ Value ComputeError(const Matrix<ArbInterval>& A,
             dval.abs();
             
             ArbInterval err(A.at(i, j).error());
-            result += dval * err;
+            result.addmul(dval, err);
         }
     }
     
@@ -34,25 +36,26 @@ Value ComputeError(const Matrix<ArbInterval>& A,
     return error;
 }
 
-void GaussInverse(Matrix<ArbInterval> A, Matrix<ArbInterval>& dA) {
+inline void GaussInverse(Matrix<ArbInterval> A, Matrix<ArbInterval>& dA) {
     size_t n = A.nrow();
     size_t m = A.ncol();
+    ArbInterval t;
 
     for (int i = n - 2; i >= 0; --i) {
         for (size_t j = n - 1; j >= i + 1; --j) {
-            ArbInterval dot = 0;
+            // one rounding for the whole sum
+            if (i + 1 < m) {
+                submul_dot(dA.at(j, i), &dA.at(j, i + 1), 1, &A.at(i, i + 1), 1,
+                           m - i - 1, t);
+            }
             
-            for (size_t k = i + 1; k < m; ++k)
-                dot += dA.at(j, k) * A.at(i, k); 
-            dA.at(j, i) -= dot;
-           
             
             for (size_t k = i + 1; k < m; ++k) {
-                dA.at(i, k) -= dA.at(j, k) * A.at(j, i);
+                dA.at(i, k).submul(dA.at(j, k), A.at(j, i));
             }
             
             for (size_t k = i + 1; k < m; ++k) {
-                A.at(j, k) += A.at(j, i) * A.at(i, k);
+                A.at(j, k).addmul(A.at(j, i), A.at(i, k));
             }
             
             dA.at(i, i) -= dA.at(j, i) * A.at(j, i) / A.at(i, i);
@@ -63,6 +66,78 @@ void GaussInverse(Matrix<ArbInterval> A, Matrix<ArbInterval>& dA) {
     }
 }
 
+// Returns Y = A^{-T} for A = LU, where LU is the result of
+// gauss_elimination() (L with unit diagonal below it, U above).
+// Y is found by one transposed solve U^T L^T Y = I, it costs O(n^3).
+// Every element is one dot product of a column of LU and a column of Y.
+inline Matrix<ArbInterval> InverseTranspose(const Matrix<ArbInterval>& LU) {
+    size_t n = LU.nrow();
+    size_t m = LU.ncol();
+    
+    Matrix<ArbInterval> Y(n, n);
+    ArbInterval t;
+    
+    // U^T Z = I, Z is lower triangular
+    for (size_t i = 0; i < n; ++i) {
+        Y.at(i, i) = 1;
+        for (size_t k = 0; k <= i; ++k) {
+            submul_dot(Y.at(i, k), &LU.at(k, i), m, &Y.at(k, k), n, i - k, t);
+            Y.at(i, k) /= LU.at(i, i);
+        }
+    }
+    
+    // L^T Y = Z
+    for (size_t i = n; i-- > 0; ) {
+        for (size_t c = 0; i + 1 < n && c < n; ++c) {
+            submul_dot(Y.at(i, c), &LU.at(i + 1, i), m, &Y.at(i + 1, c), n,
+                       n - i - 1, t);
+        }
+    }
+    
+    return Y;
+}
+
+// Computes errors of all solution components of linear equation system.
+// A - n*(n+1) system matrix, LU - A after gauss_elimination(),
+// x - the solution. Error of x_c is
+//     sum_i |A^{-1}_ci| (err A_in + sum_j err A_ij |x_j|),
+// all rows of A^{-1} are computed by InverseTranspose(), so the total
+// cost is O(n^3).
+inline std::vector<Value> ComputeSolveErrors(const Matrix<ArbInterval>& A,
+        const Matrix<ArbInterval>& LU, const Matrix<ArbInterval>& x) {
+    size_t n = A.nrow();
+    
+    Matrix<ArbInterval> Y = InverseTranspose(LU);
+    ArbInterval t;
+    
+    // w_i = err A_in + sum_j err A_ij |x_j|
+    std::vector<ArbInterval> xabs(n);
+    for (size_t j = 0; j < n; ++j) {
+        xabs[j] = x.at(j, 0);
+        xabs[j].abs();
+    }
+    
+    std::vector<ArbInterval> errors(n);
+    for (size_t i = 0; i < n; ++i) {
+        ArbInterval w(A.at(i, n).error());
+        for (size_t j = 0; j < n; ++j) {
+            w.addmul(ArbInterval(A.at(i, j).error()), xabs[j]);
+        }
+        
+        for (size_t c = 0; c < n; ++c) {
+            t = Y.at(i, c);
+            t.abs();
+            errors[c].addmul(t, w);
+        }
+    }
+    
+    std::vector<Value> result;
+    for (size_t c = 0; c < n; ++c) {
+        result.push_back(errors[c].val() + errors[c].error());
+    }
+    
+    return result;
+}
 
 }  // namespace interval
 
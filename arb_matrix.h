@@ -0,0 +1,209 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+
+#ifndef ARB_MATRIX_H
+#define ARB_MATRIX_H
+
+#include "interval.h"
+#include "matrix.h"
+
+#include "flint/arb_mat.h"
+
+#include <utility>
+
+/*
+    This file contains Matrix<ArbInterval> specialization. Its elements are
+    stored in one arb_mat_t (row-major, contiguous), so the matrix can be
+    passed to FLINT arb_mat_* functions without copying, and elimination
+    loops stream through memory.
+
+    ArbInterval consists of one arb_t, so arb_struct elements are accessed
+    as ArbInterval values in place.
+
+    ArbMatrixWindow is a view of a submatrix, it can also be passed
+    to arb_mat_* functions.
+*/
+
+namespace interval {
+
+static_assert(sizeof(ArbInterval) == sizeof(arb_struct),
+              "ArbInterval must have arb_struct layout");
+
+// Returns arb_struct element as ArbInterval.
+inline ArbInterval* as_interval(arb_ptr x) {
+    return reinterpret_cast<ArbInterval*>(x);
+}
+
+inline const ArbInterval* as_interval(arb_srcptr x) {
+    return reinterpret_cast<const ArbInterval*>(x);
+}
+
+// Matrix of ArbInterval values in arb_mat_t.
+template<>
+class Matrix<ArbInterval> {
+public:
+    // Constructed 0*0 matrix.
+    Matrix()
+    : Matrix(0, 0) {
+    }
+    
+    // Constructed nrow*ncol matrix. Sets all elements to 0.
+    Matrix(int nrow, int ncol) {
+        arb_mat_init(data_, nrow, ncol);
+    }
+    
+    // Constructed nrow*ncol matrix. Sets all elements to value.
+    Matrix(int nrow, int ncol, const ArbInterval& value)
+    : Matrix(nrow, ncol) {
+        for (int i = 0; i < nrow; ++i)
+            for (int j = 0; j < ncol; ++j)
+                at(i, j) = value;
+    }
+    
+    // Copy constructor.
+    Matrix(const Matrix& other)
+    : Matrix(other.nrow(), other.ncol()) {
+        arb_mat_set(data_, other.data_);
+    }
+    
+    // Move constructor takes other elements, other becomes 0*0 matrix.
+    Matrix(Matrix&& other)
+    : Matrix(0, 0) {
+        swap(other);
+    }
+    
+    ~Matrix() {
+        arb_mat_clear(data_);
+    }
+    
+    void swap(Matrix& other) {
+        arb_mat_swap(data_, other.data_);
+    }
+    
+    // Copy assignment reuses elements if dimensions are the same.
+    Matrix& operator=(const Matrix& other) {
+        if (nrow() != other.nrow() || ncol() != other.ncol()) {
+            Matrix temp(other);
+            swap(temp);
+        } else {
+            arb_mat_set(data_, other.data_);
+        }
+        
+        return *this;
+    }
+    
+    Matrix& operator=(Matrix&& other) {
+        swap(other);
+        return *this;
+    }
+    
+    ArbInterval& at(int r, int c) {
+        return *as_interval(arb_mat_entry(data_, r, c));
+    }
+    
+    const ArbInterval& at(int r, int c) const {
+        return *as_interval(arb_mat_entry(data_, r, c));
+    }
+    
+    int nrow() const { return arb_mat_nrows(data_); }
+    int ncol() const { return arb_mat_ncols(data_); }
+    
+    // Returns data_ value for arb_mat_* functions.
+    arb_mat_t& data() { return data_; }
+    const arb_mat_t& data() const { return data_; }
+
+private:
+    arb_mat_t data_;
+};
+
+// Submatrix view of rows r1, ..., r2 - 1 and columns c1, ..., c2 - 1.
+// The matrix must outlive the view.
+class ArbMatrixWindow {
+public:
+    ArbMatrixWindow(const Matrix<ArbInterval>& matrix,
+            int r1, int c1, int r2, int c2) {
+        arb_mat_window_init(data_, matrix.data(), r1, c1, r2, c2);
+    }
+    
+    ~ArbMatrixWindow() {
+        arb_mat_window_clear(data_);
+    }
+    
+    ArbMatrixWindow(const ArbMatrixWindow&) = delete;
+    ArbMatrixWindow& operator=(const ArbMatrixWindow&) = delete;
+    
+    ArbInterval& at(int r, int c) {
+        return *as_interval(arb_mat_entry(data_, r, c));
+    }
+    
+    const ArbInterval& at(int r, int c) const {
+        return *as_interval(arb_mat_entry(data_, r, c));
+    }
+    
+    int nrow() const { return arb_mat_nrows(data_); }
+    int ncol() const { return arb_mat_ncols(data_); }
+    
+    // Returns data_ value for arb_mat_* functions.
+    arb_mat_t& data() { return data_; }
+    const arb_mat_t& data() const { return data_; }
+
+private:
+    arb_mat_t data_;
+};
+
+inline void swap(Matrix<ArbInterval>& x, Matrix<ArbInterval>& y) {
+    x.swap(y);
+}
+
+// Row update of Gaussian elimination, y[k] = y[k] - z * x[k].
+// Rows are contiguous arb_struct arrays.
+inline void submul_row(ArbInterval* y, const ArbInterval& z,
+        const ArbInterval* x, size_t count, ArbInterval&) {
+    _arb_vec_scalar_submul(y->data(), x->data(), count, z.data(),
+                           getPrecision());
+}
+
+// Sets y = y - x[0] z[0] - ... - x[len - 1] z[len - 1] with one rounding
+// (arb_dot), r-th elements are x[r * xstep] and z[r * zstep], so rows and
+// columns of row-major matrices can be used. t is a temporary value.
+inline void submul_dot(ArbInterval& y, const ArbInterval* x, size_t xstep,
+        const ArbInterval* z, size_t zstep, size_t len, ArbInterval& t) {
+    if (len == 0) {
+        return;
+    }
+    
+    arb_dot(t.data(), y.data(), 1, x->data(), xstep, z->data(), zstep, len,
+            getPrecision());
+    y.swap(t);
+}
+
+// FLINT matrix functions.
+
+// Returns det(A).
+inline ArbInterval mat_det(const Matrix<ArbInterval>& A) {
+    ArbInterval d;
+    arb_mat_det(d.data(), A.data(), getPrecision());
+    return d;
+}
+
+// Solves A X = B. Returns false if A can not be inverted
+// at current precision.
+inline bool mat_solve(Matrix<ArbInterval>& X, const Matrix<ArbInterval>& A,
+        const Matrix<ArbInterval>& B) {
+    return arb_mat_solve(X.data(), A.data(), B.data(), getPrecision());
+}
+
+// Returns A * B.
+inline Matrix<ArbInterval> mat_mul(const Matrix<ArbInterval>& A,
+        const Matrix<ArbInterval>& B) {
+    Matrix<ArbInterval> C(A.nrow(), B.ncol());
+    arb_mat_mul(C.data(), A.data(), B.data(), getPrecision());
+    return C;
+}
+
+}  // namespace interval
+
+#endif  // ARB_MATRIX_H
@@ -0,0 +1,170 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "adaptive.h"
+#include "apost.h"
+#include "dets.h"
+#include "interval.h"
+#include "leqs.h"
+#include "matrix.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+/*
+    This file contains batch drivers for streams of independent problems
+    (determinants and linear systems of many small and medium matrices).
+
+    One problem is solved by one thread, problems are spread over ThreadPool
+    workers. Every worker takes the next unsolved problem from a shared
+    counter, so workers which got easy problems take more of them and
+    there is no idle worker while problems remain. Matrix algorithms called
+    from the workers are serial (see thread_pool.h).
+
+    Every worker has its own Workspace: a work matrix for elimination and
+    a Controller for dynamic aposteriori methods. They are reused for
+    all problems of the worker, so problems of the same size do not
+    allocate them again.
+
+    Results are returned in input order.
+
+        std::vector<Matrix<ArbInterval>> problems = ...;
+        std::vector<ArbInterval> dets = det_pivot_batch(problems);
+*/
+
+namespace interval {
+
+namespace batch {
+
+// Per-worker data reused between problems.
+struct Workspace {
+    Matrix<ArbInterval> work;
+    apost::Controller<ArbInterval> controller;
+};
+
+// Default number of problems read from a stream at once.
+const size_t kStreamWindow = 1024;
+
+}  // namespace batch
+
+// Solves problems[i] by kernel(problems[i], workspace) for all i using
+// pool workers. Returns the results in input order. An exception of
+// kernel is rethrown after all workers stop.
+template<class Result, class Kernel>
+std::vector<Result> solve_batch(
+        const std::vector<Matrix<ArbInterval>>& problems, Kernel kernel,
+        ThreadPool& pool = default_pool()) {
+    std::vector<Result> results(problems.size());
+    std::atomic<size_t> next(0);
+
+    size_t nworkers = std::max<size_t>(1, std::min(pool.size(),
+                                                    problems.size()));
+    for (size_t w = 0; w < nworkers; ++w) {
+        pool.submit([&] {
+            batch::Workspace workspace;
+            for (;;) {
+                size_t i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= problems.size()) {
+                    break;
+                }
+                results[i] = kernel(problems[i], workspace);
+            }
+        });
+    }
+    pool.wait();
+
+    return results;
+}
+
+// Stream version of solve_batch(). read(M) stores the next problem to M
+// and returns false at the end of stream, write(result) gets results
+// in input order. At most window problems are kept in memory.
+template<class Result, class Kernel>
+void solve_batch(std::function<bool(Matrix<ArbInterval>&)> read,
+        std::function<void(const Result&)> write, Kernel kernel,
+        size_t window = batch::kStreamWindow,
+        ThreadPool& pool = default_pool()) {
+    std::vector<Matrix<ArbInterval>> problems;
+    for (bool more = true; more; ) {
+        problems.clear();
+        Matrix<ArbInterval> M;
+        while (problems.size() < window && (more = read(M))) {
+            problems.push_back(std::move(M));
+            M = Matrix<ArbInterval>();
+        }
+
+        for (const Result& result :
+                solve_batch<Result>(problems, kernel, pool)) {
+            write(result);
+        }
+    }
+}
+
+// Batch versions of det_pivot(), det_inv_pivot(), det_apost(),
+// linear_solve(), leq_inv() and leq_apost().
+inline std::vector<ArbInterval> det_pivot_batch(
+        const std::vector<Matrix<ArbInterval>>& problems,
+        ThreadPool& pool = default_pool()) {
+    return solve_batch<ArbInterval>(problems,
+        [] (const Matrix<ArbInterval>& M, batch::Workspace& workspace) {
+            return det_pivot(M, workspace.work);
+        }, pool);
+}
+
+inline std::vector<ArbInterval> det_inv_pivot_batch(
+        const std::vector<Matrix<ArbInterval>>& problems,
+        ThreadPool& pool = default_pool()) {
+    return solve_batch<ArbInterval>(problems,
+        [] (const Matrix<ArbInterval>& M, batch::Workspace& workspace) {
+            return det_inv_pivot(M, workspace.work);
+        }, pool);
+}
+
+inline std::vector<ArbInterval> det_apost_batch(
+        const std::vector<Matrix<ArbInterval>>& problems,
+        ThreadPool& pool = default_pool()) {
+    return solve_batch<ArbInterval>(problems,
+        [] (const Matrix<ArbInterval>& M, batch::Workspace& workspace) {
+            return apost::det_apost(M, workspace.controller);
+        }, pool);
+}
+
+inline std::vector<Matrix<ArbInterval>> linear_solve_batch(
+        const std::vector<Matrix<ArbInterval>>& problems,
+        ThreadPool& pool = default_pool()) {
+    return solve_batch<Matrix<ArbInterval>>(problems,
+        [] (const Matrix<ArbInterval>& M, batch::Workspace& workspace) {
+            return linear_solve(M, workspace.work);
+        }, pool);
+}
+
+inline std::vector<Matrix<ArbInterval>> leq_inv_batch(
+        const std::vector<Matrix<ArbInterval>>& problems,
+        ThreadPool& pool = default_pool()) {
+    return solve_batch<Matrix<ArbInterval>>(problems,
+        [] (const Matrix<ArbInterval>& M, batch::Workspace& workspace) {
+            return leq_inv(M, workspace.work);
+        }, pool);
+}
+
+inline std::vector<Matrix<ArbInterval>> leq_apost_batch(
+        const std::vector<Matrix<ArbInterval>>& problems,
+        ThreadPool& pool = default_pool()) {
+    return solve_batch<Matrix<ArbInterval>>(problems,
+        [] (const Matrix<ArbInterval>& M, batch::Workspace& workspace) {
+            return apost::leq_apost(M, workspace.controller);
+        }, pool);
+}
+
+}  // namespace interval
+
+#endif  // BATCH_H
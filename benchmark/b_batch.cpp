@@ -0,0 +1,79 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+#include "../batch.h"
+#include "../random_matrix.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using namespace interval;
+
+// Writes throughput (matrices per second) of batch drivers for batches
+// of n*n matrices versus the number of threads.
+int main() {
+    setPrecision(256);
+
+    const size_t dims[] = {5, 10, 20, 40};
+
+    const size_t prec = 100;
+    const size_t n_problems = 256;
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::string fname = "batch_throughput.csv";
+
+    std::mt19937 generator(std::random_device{}());
+    std::uniform_real_distribution<double> distribution(-5, 5);
+    auto random = [&] () { return distribution(generator); };
+
+    // 1, 2, 4, ..., and max_threads; matrix algorithms of one problem
+    // are serial on all of them (see thread_pool.h)
+    std::vector<size_t> threads;
+    for (size_t nthreads = 1; nthreads < max_threads; nthreads *= 2) {
+        threads.push_back(nthreads);
+    }
+    threads.push_back(max_threads);
+
+    std::ofstream fout(fname);
+    for (size_t n : dims) {
+        std::vector<Matrix<ArbInterval>> dets;
+        std::vector<Matrix<ArbInterval>> systems;
+        for (size_t i = 0; i < n_problems; ++i) {
+            dets.push_back(random_matrix(n, prec, random));
+            systems.push_back(random_linear_system(n, prec, random));
+        }
+
+        for (size_t nthreads : threads) {
+            std::cout << "dim = " << n << ", threads = " << nthreads << "\n";
+            ThreadPool pool(nthreads);
+
+            auto run = [&] (const std::string& name,
+                            std::function<void()> compute) {
+                auto start = std::chrono::high_resolution_clock::now();
+                compute();
+                auto end = std::chrono::high_resolution_clock::now();
+
+                double seconds = std::chrono::duration<double>(
+                    end - start).count();
+                fout << n << "," << nthreads << "," << name << ","
+                     << n_problems / seconds << "\n";
+            };
+
+            run("trad", [&] { det_pivot_batch(dets, pool); });
+            run("stat", [&] { det_inv_pivot_batch(dets, pool); });
+            run("din", [&] { det_apost_batch(dets, pool); });
+            run("leq_trad", [&] { linear_solve_batch(systems, pool); });
+            run("leq_stat", [&] { leq_inv_batch(systems, pool); });
+            run("leq_din", [&] { leq_apost_batch(systems, pool); });
+        }
+    }
+
+    return 0;
+}
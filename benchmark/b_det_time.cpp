@@ -4,6 +4,7 @@
 # Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
 
 #include "../apost.h"
+#include "../apost_program.h"
 #include "../dets.h"
 #include "../random_matrix.h"
 
@@ -57,6 +58,68 @@ int main() {
             std::chrono::milliseconds>(end - start).count() << ",din,"
             << n_iters << "\n";
         
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t counter = 0; counter < n_iters; ++counter) {
+            controller = Controller<ArbInterval>();
+            controller.set_mode(Controller<ArbInterval>::kMagMode);
+            Matrix<ProxyInterval<ArbInterval>> m_apost(n, n);
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    m_apost.at(i, j) = m.at(i, j);
+                    
+            controller.init();
+            ProxyIntervalResult result;
+            result = det_pivot(m_apost);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        
+        fout << n << "," << std::chrono::duration_cast<
+            std::chrono::milliseconds>(end - start).count() << ",din_mag,"
+            << n_iters << "\n";
+        
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t counter = 0; counter < n_iters; ++counter) {
+            controller = Controller<ArbInterval>();
+            controller.set_forward(Controller<ArbInterval>::kMidpointForward);
+            Matrix<ProxyInterval<ArbInterval>> m_apost(n, n);
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    m_apost.at(i, j) = m.at(i, j);
+                    
+            controller.init();
+            ProxyIntervalResult result;
+            result = det_pivot(m_apost);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        
+        fout << n << "," << std::chrono::duration_cast<
+            std::chrono::milliseconds>(end - start).count() << ",din_mid,"
+            << n_iters << "\n";
+        
+        std::vector<ArbInterval> inputs;
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                inputs.push_back(m.at(i, j));
+        
+        auto kernel = [n] (const std::vector<ProxyInterval<ArbInterval>>& x) {
+            Matrix<ProxyInterval<ArbInterval>> m_apost(n, n);
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    m_apost.at(i, j) = x[i * n + j];
+            return det_pivot(m_apost);
+        };
+        
+        Program<ArbInterval> program;
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t counter = 0; counter < n_iters; ++counter) {
+            ArbInterval result = replay_or_record(program, inputs, kernel);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        
+        fout << n << "," << std::chrono::duration_cast<
+            std::chrono::milliseconds>(end - start).count() << ",din_prog,"
+            << n_iters << "\n";
+        
         start = std::chrono::high_resolution_clock::now();
         for (size_t counter = 0; counter < n_iters; ++counter) {
             ArbInterval result = det_pivot(m);
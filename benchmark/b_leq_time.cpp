@@ -75,6 +75,26 @@ int main() {
         fout << n << "," << std::chrono::duration_cast<
             std::chrono::milliseconds>(end - start).count() << ",stat,"
             << n_iters << "\n";
+        
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t counter = 0; counter < n_iters; ++counter) {
+            Matrix<ArbInterval> result = linear_solve_verified(m);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        
+        fout << n << "," << std::chrono::duration_cast<
+            std::chrono::milliseconds>(end - start).count() << ",verified,"
+            << n_iters << "\n";
+        
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t counter = 0; counter < n_iters; ++counter) {
+            Matrix<ArbInterval> result = linear_solve_refined(m);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        
+        fout << n << "," << std::chrono::duration_cast<
+            std::chrono::milliseconds>(end - start).count() << ",refined,"
+            << n_iters << "\n";
     }
     
     return 0;
@@ -0,0 +1,67 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+#include "../crout.h"
+#include "../random_matrix.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using namespace interval;
+
+// Writes time of lu_crout() for n*n matrices and its speedup versus
+// the number of threads.
+int main() {
+    setPrecision(1024);
+
+    const size_t dims[] = {50, 100, 200, 400};
+
+    const size_t prec = 100;
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::string fname = "lu_time.csv";
+
+    std::mt19937 generator(std::random_device{}());
+    std::uniform_real_distribution<double> distribution(-5, 5);
+    auto random = [&] () { return distribution(generator); };
+
+    // 1, 2, 4, ..., and max_threads
+    std::vector<size_t> threads;
+    for (size_t nthreads = 1; nthreads < max_threads; nthreads *= 2) {
+        threads.push_back(nthreads);
+    }
+    threads.push_back(max_threads);
+
+    std::ofstream fout(fname);
+    for (size_t n : dims) {
+        Matrix<ArbInterval> matrix = random_matrix(n, prec, random);
+
+        double serial = 0;
+        for (size_t nthreads : threads) {
+            std::cout << "dim = " << n << ", threads = " << nthreads << "\n";
+            ThreadPool pool(nthreads);
+
+            Matrix<ArbInterval> lu = matrix;
+            std::vector<int> perm;
+            auto start = std::chrono::high_resolution_clock::now();
+            lu_crout(lu, &perm, pool);
+            auto end = std::chrono::high_resolution_clock::now();
+
+            double seconds = std::chrono::duration<double>(end - start).count();
+            if (nthreads == 1) {
+                serial = seconds;
+            }
+            fout << n << "," << nthreads << "," << seconds << ","
+                 << serial / seconds << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,253 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+
+#ifndef CROUT_H
+#define CROUT_H
+
+#include "gauss.h"
+#include "interval.h"
+#include "matrix.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/*
+    This file contains Crout ordered (left-looking) LU factorization and
+    triangular solves of Matrix<ArbInterval>.
+
+    Every element of the factors is computed as one dot product of a row
+    and a column of already computed elements:
+        U_kj = A_kj - sum_{r<k} L_kr U_rj,
+        L_ik = (A_ik - sum_{r<k} L_ir U_rk) / U_kk.
+    Dot products are evaluated by arb_dot() with one rounding, so there
+    are no temporaries and results have smaller radii than elimination
+    with a rounding for each multiplication and subtraction.
+
+    The factorization is blocked for ThreadPool tasks. For every panel of
+    kLuBlock columns:
+        1) the panel (block columns, rows below the block) is factorized
+           by Crout steps, rows are computed by tasks of kLuTile rows;
+        2) block rows to the right of the panel (U12) are computed by
+           tasks of kLuTile columns;
+        3) the trailing submatrix is updated by kLuTile x kLuTile tiles,
+           every tile is an independent task:
+               A22 = A22 - L21 U12.
+    So the sums above have one rounding per panel, a matrix of at most
+    kLuBlock rows gets the unblocked Crout factorization.
+*/
+
+namespace interval {
+
+// Number of columns of lu_crout() panel.
+const size_t kLuBlock = 16;
+// Number of rows (columns) of lu_crout() tile.
+const size_t kLuTile = 8;
+
+// Appends tasks calling f(i, t) for i = begin, ..., end - 1 by chunks of
+// kLuTile indices, t is a temporary value of the task.
+template<class F>
+void push_range_tasks(std::vector<std::function<void()>>& tasks,
+        size_t begin, size_t end, F f) {
+    for (size_t i0 = begin; i0 < end; i0 += kLuTile) {
+        size_t i1 = std::min(i0 + kLuTile, end);
+        tasks.push_back([=] {
+            ArbInterval t;
+            for (size_t i = i0; i < i1; ++i) {
+                f(i, t);
+            }
+        });
+    }
+}
+
+// Runs tasks on pool and clears them, a single task is run in place.
+inline void run_tasks(ThreadPool& pool,
+        std::vector<std::function<void()>>& tasks) {
+    if (tasks.size() == 1) {
+        tasks[0]();
+    } else {
+        for (auto& task : tasks) {
+            pool.submit(task);
+        }
+        pool.wait();
+    }
+    tasks.clear();
+}
+
+// Performs the Crout LU factorization of n*m matrix (m >= n), the last
+// m - n columns become L^{-1} of them. If perm is not null, pivoting
+// is used and rows are not moved: i-th row of the result is row perm[i]
+// of matrix. Returns (-1)^(number of permutations).
+inline int lu_crout(Matrix<ArbInterval>& matrix, std::vector<int>* perm,
+        ThreadPool& pool = default_pool()) {
+    size_t n = matrix.nrow();
+    size_t m = matrix.ncol();
+
+    std::vector<int> rows(n);
+    for (size_t i = 0; i < n; ++i) {
+        rows[i] = i;
+    }
+
+    int sign = 1;
+    std::vector<std::function<void()>> tasks;
+
+    // rows are swapped during the factorization and moved back at the end
+    for (size_t k0 = 0; k0 < n; k0 += kLuBlock) {
+        size_t k1 = std::min(k0 + kLuBlock, n);
+
+        // 1) panel
+        for (size_t k = k0; k < k1; ++k) {
+            // column k of L (not divided by pivot), column k - 1 of L
+            // is divided by its pivot
+            push_range_tasks(tasks, k, n, [&, k0, k] (size_t i,
+                                                      ArbInterval& t) {
+                if (k > k0) {
+                    matrix.at(i, k - 1) /= matrix.at(k - 1, k - 1);
+                }
+                submul_dot(matrix.at(i, k), &matrix.at(i, k0), 1,
+                           &matrix.at(k0, k), m, k - k0, t);
+            });
+            run_tasks(pool, tasks);
+
+            if (perm) {
+                int p = select_pivot(n - k,
+                    [&] (size_t i) -> const ArbInterval& {
+                        return matrix.at(k + i, k);
+                    });
+                if (p > 0) {
+                    for (size_t j = 0; j < m; ++j) {
+                        matrix.at(k, j).swap(matrix.at(k + p, j));
+                    }
+                    std::swap(rows[k], rows[k + p]);
+                    sign *= -1;
+                }
+            }
+
+            // row k of U in the panel
+            ArbInterval t;
+            for (size_t j = k + 1; j < k1; ++j) {
+                submul_dot(matrix.at(k, j), &matrix.at(k, k0), 1,
+                           &matrix.at(k0, j), m, k - k0, t);
+            }
+        }
+
+        // the last column of L in the panel and 2) U12
+        push_range_tasks(tasks, k1, n, [&, k1] (size_t i, ArbInterval&) {
+            matrix.at(i, k1 - 1) /= matrix.at(k1 - 1, k1 - 1);
+        });
+        push_range_tasks(tasks, k1, m, [&, k0, k1] (size_t j,
+                                                    ArbInterval& t) {
+            for (size_t k = k0 + 1; k < k1; ++k) {
+                submul_dot(matrix.at(k, j), &matrix.at(k, k0), 1,
+                           &matrix.at(k0, j), m, k - k0, t);
+            }
+        });
+        run_tasks(pool, tasks);
+
+        // 3) A22 by tiles
+        for (size_t i0 = k1; i0 < n; i0 += kLuTile) {
+            size_t i1 = std::min(i0 + kLuTile, n);
+            for (size_t j0 = k1; j0 < m; j0 += kLuTile) {
+                size_t j1 = std::min(j0 + kLuTile, m);
+                tasks.push_back([&, k0, k1, i0, i1, j0, j1] {
+                    ArbInterval t;
+                    for (size_t i = i0; i < i1; ++i) {
+                        for (size_t j = j0; j < j1; ++j) {
+                            submul_dot(matrix.at(i, j), &matrix.at(i, k0), 1,
+                                       &matrix.at(k0, j), m, k1 - k0, t);
+                        }
+                    }
+                });
+            }
+        }
+        run_tasks(pool, tasks);
+    }
+
+    if (perm) {
+        // i-th row goes to row rows[i]
+        std::vector<int> target = rows;
+        for (size_t i = 0; i < n; ++i) {
+            while (target[i] != static_cast<int>(i)) {
+                size_t r = target[i];
+                for (size_t j = 0; j < m; ++j) {
+                    matrix.at(i, j).swap(matrix.at(r, j));
+                }
+                std::swap(target[i], target[r]);
+            }
+        }
+
+        perm->swap(rows);
+    }
+
+    return sign;
+}
+
+// Solves L X = B in place of B, L is unit lower triangular part of the
+// first n columns of lu (the result of lu_crout() with rows in pivot order).
+inline void solve_unit_lower(const Matrix<ArbInterval>& lu,
+        Matrix<ArbInterval>& B) {
+    size_t n = B.nrow();
+    size_t k = B.ncol();
+
+    ArbInterval t;
+    for (size_t i = 1; i < n; ++i) {
+        for (size_t c = 0; c < k; ++c) {
+            submul_dot(B.at(i, c), &lu.at(i, 0), 1, &B.at(0, c), k, i, t);
+        }
+    }
+}
+
+// Solves U X = B in place of B, U is upper triangular part of the first
+// n columns of lu.
+inline void solve_upper(const Matrix<ArbInterval>& lu, Matrix<ArbInterval>& B) {
+    size_t n = B.nrow();
+    size_t k = B.ncol();
+
+    ArbInterval t;
+    for (size_t i = n; i-- > 0; ) {
+        for (size_t c = 0; c < k; ++c) {
+            if (i + 1 < n) {
+                submul_dot(B.at(i, c), &lu.at(i, i + 1), 1, &B.at(i + 1, c),
+                           k, n - i - 1, t);
+            }
+            B.at(i, c) /= lu.at(i, i);
+        }
+    }
+}
+
+// Matrix<ArbInterval> versions of gauss.h functions, det(), det_pivot()
+// and linear_solve() use them.
+inline void gauss_elimination(Matrix<ArbInterval>& matrix) {
+    lu_crout(matrix, nullptr);
+}
+
+inline int gauss_elimination_pivot(Matrix<ArbInterval>& matrix,
+        std::vector<int>& perm) {
+    return lu_crout(matrix, &perm);
+}
+
+// Matrix<ArbInterval> version of back_substitution() (leqs.h): solves
+// U x = c for eliminated n*m system M, c - the last m - n columns.
+inline Matrix<ArbInterval> back_substitution(const Matrix<ArbInterval>& M) {
+    size_t n = M.nrow();
+    size_t k = M.ncol() - n;
+
+    Matrix<ArbInterval> x(n, k);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t c = 0; c < k; ++c) {
+            x.at(i, c) = M.at(i, n + c);
+        }
+    }
+    solve_upper(M, x);
+
+    return x;
+}
+
+}  // namespace interval
+
+#endif  // CROUT_H
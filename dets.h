@@ -7,6 +7,7 @@
 #define DETS_H
 
 #include "apost_statical.h"
+#include "crout.h"
 #include "gauss.h"
 #include "interval.h"
 #include "matrix.h"
@@ -23,32 +24,49 @@ IntervalT det(Matrix<IntervalT> matrix) {
     
     IntervalT d = IntervalT(1);
     for (size_t i = 0; i < n; ++i)
-        d = d * matrix.at(i, i);
+        d *= matrix.at(i, i);
 
     return d;
 }
 
 // Computes the determenant of matrix using Gauss
-// elimination (with pivoting).
+// elimination (with pivoting), matrix is replaced by its elimination.
 template<class IntervalT>
-IntervalT det_pivot(Matrix<IntervalT> matrix) {
+IntervalT det_pivot_in_place(Matrix<IntervalT>& matrix) {
     size_t n = matrix.nrow();
     
-    int sign = gauss_elimination_pivot(matrix);
+    // diagonal is enough, so rows are not moved
+    std::vector<int> perm;
+    int sign = gauss_elimination_pivot(matrix, perm);
 
     IntervalT d = IntervalT(1);
     for (size_t i = 0; i < n; ++i) {
-        d = d * matrix.at(i, i);
+        d *= matrix.at(perm[i], i);
     }
     d = IntervalT(sign) * d;
     
     return d;
 }
 
+// Computes the determenant of matrix using Gauss
+// elimination (with pivoting).
+template<class IntervalT>
+IntervalT det_pivot(Matrix<IntervalT> matrix) {
+    return det_pivot_in_place(matrix);
+}
+
+// The same as det_pivot(M), the elimination is performed in work matrix.
+// Its elements are reused if it has the same size as M.
+template<class IntervalT>
+IntervalT det_pivot(const Matrix<IntervalT>& M, Matrix<IntervalT>& work) {
+    work = M;
+    return det_pivot_in_place(work);
+}
+
 // Computes the determenant of matrix using Gaussian
 // elimination (without pivoting) and statical implementation
 // of aposteriori method.
-ArbInterval det_inv(Matrix<ArbInterval> M) {
+inline ArbInterval det_inv(Matrix<ArbInterval> M) {
     Matrix<ArbInterval> init = M;
     size_t n = M.nrow();
     
@@ -64,7 +82,7 @@ ArbInterval det_inv(Matrix<ArbInterval> M) {
 
     ArbInterval f = 1;
     for (size_t i = 0; i < n; ++i) {
-        f = f * M.at(i, i);
+        f *= M.at(i, i);
     }
     ArbInterval det = f;
     
@@ -74,7 +92,7 @@ ArbInterval det_inv(Matrix<ArbInterval> M) {
     // inverse step
     for (int i = n - 1; i >= 0; --i) {
         f /= M.at(i, i);
-        dM.at(i, i) += df * f;
+        dM.at(i, i).addmul(df, f);
         df *= M.at(i, i);
     }
     
@@ -86,11 +104,10 @@ ArbInterval det_inv(Matrix<ArbInterval> M) {
 
 // Computes the determenant of matrix using Gaussian
 // elimination (with pivoting) and statical implementation
-// of aposteriori method.
-ArbInterval det_inv_pivot(Matrix<ArbInterval> M) {
-    Matrix<ArbInterval> init = M;
-    Matrix<ArbInterval> i2 = M;
-
+// of aposteriori method. The elimination is performed in work matrix,
+// its elements are reused if it has the same size as M.
+inline ArbInterval det_inv_pivot(const Matrix<ArbInterval>& M,
+        Matrix<ArbInterval>& work) {
     size_t n = M.nrow();
     if (n == 0) {
         return ArbInterval(0);
@@ -100,11 +117,12 @@ ArbInterval det_inv_pivot(Matrix<ArbInterval> M) {
         return M.at(0, 0);
     }
     
-    int sign = gauss_elimination_pivot(M);
+    work = M;
+    int sign = gauss_elimination_pivot(work);
 
     ArbInterval f = 1;
     for (size_t i = 0; i < n; ++i) {
-        f = f * M.at(i, i);
+        f *= work.at(i, i);
     }
     ArbInterval det = ArbInterval(sign) * f;
     
@@ -113,17 +131,22 @@ ArbInterval det_inv_pivot(Matrix<ArbInterval> M) {
     
     // inverse step
     for (int i = n - 1; i >= 0; --i) {
-        f /= M.at(i, i);
-        dM.at(i, i) += df * f;
-        df *= M.at(i, i);
+        f /= work.at(i, i);
+        dM.at(i, i).addmul(df, f);
+        df *= work.at(i, i);
     }
 
-    GaussInverse(M, dM);
-    det = ArbInterval(det.val(), ComputeError(init, dM));
+    GaussInverse(work, dM);
+    det = ArbInterval(det.val(), ComputeError(M, dM));
     
     return det;
 }
 
+inline ArbInterval det_inv_pivot(const Matrix<ArbInterval>& M) {
+    Matrix<ArbInterval> work;
+    return det_inv_pivot(M, work);
+}
+
 }  // namespace interval
 
 #endif  // DETS_H
@@ -0,0 +1,332 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+#ifndef DOUBLE_INTERVAL_H
+#define DOUBLE_INTERVAL_H
+
+#include "magnitude.h"
+#include "precision.h"
+#include "value.h"
+
+#include "flint/arf.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+/*
+    This file contains rigorous interval type with native double midpoint
+    and radius. It can be used everywhere instead of ArbInterval, when 53-bit
+    midpoints are enough (inputs with moderate radii).
+
+    All operations are computed in the default rounding to nearest mode.
+    The radius of result is increased by the midpoint rounding error and
+    then inflated by a few units in the last place, so it is always an
+    upper bound of exact result error, as in [1]. The radius becomes
+    infinite on overflow or division by interval containing zero.
+
+        [1] Rump, S.M., Fast and parallel interval arithmetic, BIT Numerical
+            Mathematics, Volume 39, 1999, pp. 534-554.
+*/
+
+namespace interval {
+
+namespace double_interval {
+
+// Unit roundoff 2^-53.
+const double kUnit = std::numeric_limits<double>::epsilon() / 2;
+// Smallest positive subnormal number.
+const double kEta = std::numeric_limits<double>::denorm_min();
+
+// Returns an upper bound of exact nonnegative value which was computed
+// with at most 5 rounding to nearest operations as x.
+inline double inflate(double x) {
+    return x * (1 + 8 * kUnit) + 4 * kEta;
+}
+
+// Returns a lower bound of exact nonnegative value which was computed
+// with one rounding to nearest operation as x.
+inline double deflate(double x) {
+    return x * (1 - 4 * kUnit) - 4 * kEta;
+}
+
+// Midpoint-radius kernels, c = a op b.
+inline void add(double am, double ar, double bm, double br,
+        double& cm, double& cr) {
+    cm = am + bm;
+    cr = inflate(ar + br + kUnit * std::fabs(cm));
+}
+
+inline void sub(double am, double ar, double bm, double br,
+        double& cm, double& cr) {
+    cm = am - bm;
+    cr = inflate(ar + br + kUnit * std::fabs(cm));
+}
+
+inline void mul(double am, double ar, double bm, double br,
+        double& cm, double& cr) {
+    cm = am * bm;
+    cr = inflate(std::fabs(am) * br + ar * (std::fabs(bm) + br) +
+                 kUnit * std::fabs(cm));
+}
+
+// |a/b - am/bm| <= (|am| br + ar |bm|) / (|bm| (|bm| - br)).
+inline void div(double am, double ar, double bm, double br,
+        double& cm, double& cr) {
+    double b = std::fabs(bm);
+    double num = inflate(std::fabs(am) * br + ar * b);
+    double den = deflate(b * deflate(b - br));
+
+    cm = am / bm;
+    cr = inflate(num / den + kUnit * std::fabs(cm));
+    // b contains zero
+    cm = den > 0 ? cm : 0;
+    cr = den > 0 ? cr : std::numeric_limits<double>::infinity();
+}
+
+}  // namespace double_interval
+
+// Class to work with native double interval values.
+class DoubleInterval {
+public:
+
+    // Constructors.
+    DoubleInterval()
+    : mid_(0)
+    , rad_(0) {
+    }
+
+    DoubleInterval(double value, double rad)
+    : mid_(value)
+    , rad_(std::fabs(rad)) {
+    }
+
+    DoubleInterval(double value)
+    : mid_(value)
+    , rad_(0) {
+    }
+
+    // Rounds value to the nearest double and adds rounding error
+    // to radius.
+    DoubleInterval(const Value& value)
+    : DoubleInterval() {
+        set(value, Value());
+    }
+
+    DoubleInterval(const Value& value, const Value& rad)
+    : DoubleInterval() {
+        set(value, rad);
+    }
+
+    void swap(DoubleInterval& other) {
+        std::swap(mid_, other.mid_);
+        std::swap(rad_, other.rad_);
+    }
+
+    // Arithmetical operations.
+    DoubleInterval& operator+=(const DoubleInterval& x) {
+        double_interval::add(mid_, rad_, x.mid_, x.rad_, mid_, rad_);
+        return *this;
+    }
+
+    DoubleInterval& operator-=(const DoubleInterval& x) {
+        double_interval::sub(mid_, rad_, x.mid_, x.rad_, mid_, rad_);
+        return *this;
+    }
+
+    DoubleInterval& operator*=(const DoubleInterval& x) {
+        double_interval::mul(mid_, rad_, x.mid_, x.rad_, mid_, rad_);
+        return *this;
+    }
+
+    DoubleInterval& operator/=(const DoubleInterval& x) {
+        double_interval::div(mid_, rad_, x.mid_, x.rad_, mid_, rad_);
+        return *this;
+    }
+
+    // Sets the interval to *this + x * y.
+    DoubleInterval& addmul(const DoubleInterval& x, const DoubleInterval& y) {
+        DoubleInterval t = x;
+        t *= y;
+        return *this += t;
+    }
+
+    // Sets the interval to *this - x * y.
+    DoubleInterval& submul(const DoubleInterval& x, const DoubleInterval& y) {
+        DoubleInterval t = x;
+        t *= y;
+        return *this -= t;
+    }
+
+    // Sets the interval to its negation.
+    void neg() {
+        mid_ = -mid_;
+    }
+
+    // Returns value value.
+    Value val() const {
+        Value temp;
+        arf_set_d(temp.data_, mid_);
+
+        return temp;
+    }
+
+    // Returns error value.
+    Value error() const {
+        Value temp;
+        arf_set_d(temp.data_, rad_);
+
+        return temp;
+    }
+
+    // Returns right bound of absolute value of the interval.
+    Value abs_ubound() const {
+        Value temp;
+        arf_set_d(temp.data_, upper_abs());
+
+        return temp;
+    }
+
+    // Returns left bound of absolute value of the interval.
+    Value abs_lbound() const {
+        Value temp;
+        double x = double_interval::deflate(std::fabs(mid_) - rad_);
+        arf_set_d(temp.data_, x > 0 ? x : 0);
+
+        return temp;
+    }
+
+    // Returns right bound of absolute value of the interval as
+    // upward rounded magnitude.
+    Magnitude mag() const {
+        return Magnitude(upper_abs());
+    }
+
+    // Sets the interval to zero.
+    void zero() {
+        mid_ = 0;
+        rad_ = 0;
+    }
+
+    // Sets the interval to its absolute value.
+    void abs() {
+        mid_ = std::fabs(mid_);
+    }
+
+    double mid() const { return mid_; }
+    double rad() const { return rad_; }
+
+    // Comparision functions, the same semantics as for ArbInterval.
+    bool eq(const DoubleInterval& x) const {
+        return rad_ == 0 && x.rad_ == 0 && mid_ == x.mid_;
+    }
+    bool ne(const DoubleInterval& x) const { return lt(x) || gt(x); }
+    bool lt(const DoubleInterval& x) const { return upper() < x.lower(); }
+    bool le(const DoubleInterval& x) const { return upper() <= x.lower(); }
+    bool gt(const DoubleInterval& x) const { return x.lt(*this); }
+    bool ge(const DoubleInterval& x) const { return x.le(*this); }
+
+    // Returns true if contains zero; otherwise returns false.
+    bool contains_zero() const { return !(std::fabs(mid_) > rad_); }
+
+    // Output functions.
+    friend std::ostream& operator<<(std::ostream& os, const DoubleInterval& x) {
+        os << "[" << x.mid_ << " +/- " << x.rad_ << "]";
+        return os;
+    }
+
+private:
+    double mid_;
+    double rad_;
+
+    // Bounds of the interval.
+    double upper() const {
+        return std::nextafter(mid_ + rad_, std::numeric_limits<double>::infinity());
+    }
+    double lower() const {
+        return std::nextafter(mid_ - rad_, -std::numeric_limits<double>::infinity());
+    }
+    double upper_abs() const {
+        return double_interval::inflate(std::fabs(mid_) + rad_);
+    }
+
+    void set(const Value& value, const Value& rad) {
+        mid_ = arf_get_d(value.data_, ARF_RND_NEAR);
+
+        Value err;
+        arf_set_d(err.data_, mid_);
+        arf_sub(err.data_, value.data_, err.data_, getPrecision(), ARF_RND_UP);
+        arf_abs(err.data_, err.data_);
+        arf_add(err.data_, err.data_, rad.data_, getPrecision(), ARF_RND_UP);
+        rad_ = arf_get_d(err.data_, ARF_RND_UP);
+    }
+};
+
+// Comparision functions.
+inline bool operator==(const DoubleInterval& x, const DoubleInterval& y) {
+    return x.eq(y);
+}
+
+inline bool operator!=(const DoubleInterval& x, const DoubleInterval& y) {
+    return x.ne(y);
+}
+
+inline bool operator<(const DoubleInterval& x, const DoubleInterval& y) {
+    return x.lt(y);
+}
+
+inline bool operator<=(const DoubleInterval& x, const DoubleInterval& y) {
+    return x.le(y);
+}
+
+inline bool operator>(const DoubleInterval& x, const DoubleInterval& y) {
+    return x.gt(y);
+}
+
+inline bool operator>=(const DoubleInterval& x, const DoubleInterval& y) {
+    return x.ge(y);
+}
+
+// Arithmetic operations.
+inline DoubleInterval operator+(DoubleInterval x, const DoubleInterval& y) {
+    x += y;
+    return x;
+}
+
+inline DoubleInterval operator-(DoubleInterval x, const DoubleInterval& y) {
+    x -= y;
+    return x;
+}
+
+inline DoubleInterval operator*(DoubleInterval x, const DoubleInterval& y) {
+    x *= y;
+    return x;
+}
+
+inline DoubleInterval operator/(DoubleInterval x, const DoubleInterval& y) {
+    x /= y;
+    return x;
+}
+
+inline DoubleInterval operator-(DoubleInterval x) {
+    x.neg();
+    return x;
+}
+
+inline void swap(DoubleInterval& x, DoubleInterval& y) {
+    x.swap(y);
+}
+
+// Row update kernel of Gaussian elimination: y[k] -= z * x[k].
+inline void submul_row(DoubleInterval* y, const DoubleInterval& z,
+        const DoubleInterval* x, size_t count, DoubleInterval&) {
+    for (size_t k = 0; k < count; ++k) {
+        y[k].submul(z, x[k]);
+    }
+}
+
+}  // namespace interval
+
+#endif  // DOUBLE_INTERVAL_H
@@ -40,11 +40,14 @@ int main() {
     ProxyInterval<ArbInterval> x3 = x1 * x0;
     ProxyInterval<ArbInterval> x4 = x3 / x2;
     
+    // values are read before evaluate(), it clears the controller
+    ArbInterval exact = ArbInterval(x1) / ArbInterval(x0);
+    ArbInterval traditional = x4;
     ArbInterval y = controller.evaluate();
     
     std::cout << "--------------------------------------------------\n";
-    std::cout << "True value :        " << x1 / x0 << std::endl;
-    std::cout << "Traditional value : " << x4 << std::endl;
+    std::cout << "True value :        " << exact << std::endl;
+    std::cout << "Traditional value : " << traditional << std::endl;
     std::cout << "Aposteriori value : " << y << std::endl;
     
     return 0;
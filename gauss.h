@@ -6,33 +6,96 @@
 #ifndef GAUSS_H
 #define GAUSS_H
 
+#include "magnitude.h"
 #include "matrix.h"
 
+#include <utility>
+#include <vector>
+
 /*
     This file contains Gaussian elimination methods.
 */
 
 namespace interval {
 
-// Finds the pivot element for Gaussian elimination.
-template<class IntervalT>
-int find_pivot(const Matrix<IntervalT> &matrix, size_t r, size_t c) {
-    int best_row = -1;
+// Selects the pivot among count candidates, candidate(i) returns i-th of
+// them. Returns the index of the candidate with the largest magnitude
+// or -1 if all of them contain zero. Magnitudes are compared as cached
+// mag_t upper bounds, so there are no Value temporaries.
+template<class Candidate>
+int select_pivot(size_t count, Candidate candidate) {
+    int best = -1;
+    Magnitude best_mag;
     
-    for (size_t i = r; i < matrix.nrow(); ++i) {
-        // if element at (i, c) does not contain zero
-        if (!((ArbInterval)(matrix.at(i, c))).contains_zero()) {
-            if (best_row == -1) {
-                best_row = i;
+    for (size_t i = 0; i < count; ++i) {
+        const auto& x = candidate(i);
+        // if candidate does not contain zero
+        if (!x.contains_zero()) {
+            Magnitude mag = x.mag();
             // if abs(new) upper bound > abs(old) upper bound
-            } else if (((ArbInterval)(matrix.at(i, c))).abs_ubound() >
-                        ((ArbInterval)(matrix.at(best_row, c))).abs_ubound()) {
-                best_row = i;
+            if (best == -1 || mag > best_mag) {
+                best = i;
+                best_mag.swap(mag);
             }
         }
     }
     
-    return best_row;
+    return best;
+}
+
+// Called by find_pivot() with the pivot choice among candidate rows
+// rows[0], ..., rows[count - 1]. Does nothing for simple intervals,
+// apost.h overloads it to record the choice.
+template<class IntervalT>
+void on_pivot(const Matrix<IntervalT>&, const int*, size_t, size_t, int) {
+}
+
+// Finds the pivot element of column c for Gaussian elimination among
+// rows perm[r], ..., perm[n - 1]. Returns its index in perm or -1.
+template<class IntervalT>
+int find_pivot(const Matrix<IntervalT>& matrix, const std::vector<int>& perm,
+        size_t r, size_t c) {
+    size_t count = matrix.nrow() - r;
+    int best = select_pivot(count, [&] (size_t i) -> const IntervalT& {
+        return matrix.at(perm[r + i], c);
+    });
+    
+    on_pivot(matrix, &perm[r], count, c, best);
+    
+    return best == -1 ? -1 : r + best;
+}
+
+// Reorders rows of matrix, i-th row becomes row perm[i].
+template<class IntervalT>
+void permute_rows(Matrix<IntervalT>& matrix, const std::vector<int>& perm) {
+    using std::swap;
+    
+    for (size_t i = 0; i < perm.size(); ++i) {
+        // row perm[i] was moved by previous swaps
+        size_t k = perm[i];
+        while (k < i) {
+            k = perm[k];
+        }
+        
+        if (k != i) {
+            for (size_t j = 0; j < matrix.ncol(); ++j) {
+                swap(matrix.at(i, j), matrix.at(k, j));
+            }
+        }
+    }
+}
+
+// Computes y[k] = y[k] - z * x[k] for k = 0, ..., count - 1.
+// t is a temporary value. Interval types with array kernels
+// overload this function.
+template<class IntervalT>
+void submul_row(IntervalT* y, const IntervalT& z, const IntervalT* x,
+        size_t count, IntervalT& t) {
+    for (size_t k = 0; k < count; ++k) {
+        t = z;
+        t *= x[k];
+        y[k] -= t;
+    }
 }
 
 // Performs the Gaussian elimination of matrix (without pivoting).
@@ -41,49 +104,63 @@ void gauss_elimination(Matrix<IntervalT>& matrix) {
     size_t n = matrix.nrow();
     size_t m = matrix.ncol();
     
+    // t is reused, so the row updates do not allocate temporaries
+    IntervalT t;
     for (size_t i = 0; i < n; ++i) {
         for (size_t j = i + 1; j < n; ++j) {
-            IntervalT z = matrix.at(j, i) / matrix.at(i, i);
-            matrix.at(j, i) = z;
-            for (size_t k = i + 1; k < m; ++k) {
-                IntervalT t = z * matrix.at(i, k);
-                matrix.at(j, k) = matrix.at(j, k) - t;
-            }
+            matrix.at(j, i) /= matrix.at(i, i);
+            submul_row(&matrix.at(j, i + 1), matrix.at(j, i),
+                       &matrix.at(i, i + 1), m - i - 1, t);
         }
     }
 }
 
-// Performs the Gaussian elimination of matrix (with pivoting).
+// Performs the Gaussian elimination of matrix (with pivoting) without
+// moving rows: i-th row of the result is row perm[i] of matrix.
 // Returns (-1)^(number of permutations).
 template<class IntervalT>
-int gauss_elimination_pivot(Matrix<IntervalT>& matrix) {
+int gauss_elimination_pivot(Matrix<IntervalT>& matrix, std::vector<int>& perm) {
     size_t n = matrix.nrow();
     size_t m = matrix.ncol();
     
+    perm.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        perm[i] = i;
+    }
+    
     int sign = 1;
 
+    IntervalT t;
     for (size_t i = 0; i < n; ++i) {
-        int r = find_pivot(matrix, i, i);
-        if (i != r) {
-            for (size_t j = 0; j < m; ++j) {
-                std::swap(matrix.at(i, j), matrix.at(r, j));
-            }
+        int r = find_pivot(matrix, perm, i, i);
+        if (r != -1 && r != i) {
+            std::swap(perm[i], perm[r]);
             sign *= -1;
         }
         
+        int p = perm[i];
         for (size_t j = i + 1; j < n; ++j) {
-            IntervalT z = matrix.at(j, i) / matrix.at(i, i);
-            matrix.at(j, i) = z;
-            for (size_t k = i + 1; k < m; ++k) {
-                IntervalT temp = z * matrix.at(i, k);
-                matrix.at(j, k) = matrix.at(j, k) - temp;
-            }
+            int row = perm[j];
+            matrix.at(row, i) /= matrix.at(p, i);
+            submul_row(&matrix.at(row, i + 1), matrix.at(row, i),
+                       &matrix.at(p, i + 1), m - i - 1, t);
         }
     }
     
     return sign;
 }
 
+// Performs the Gaussian elimination of matrix (with pivoting).
+// Returns (-1)^(number of permutations).
+template<class IntervalT>
+int gauss_elimination_pivot(Matrix<IntervalT>& matrix) {
+    std::vector<int> perm;
+    int sign = gauss_elimination_pivot(matrix, perm);
+    permute_rows(matrix, perm);
+    
+    return sign;
+}
+
 }  // namespace interval
 
 #endif  // GAUSS_H
@@ -6,12 +6,14 @@
 #ifndef INTERVAL_H
 #define INTERVAL_H
 
+#include "magnitude.h"
 #include "precision.h"
 #include "value.h"
 
 #include "flint/arb.h"
 
 #include <iostream>
+#include <utility>
 
 /*
     This file contains  C++ wrapper of Arb library arb_t type for arbitary
@@ -47,6 +49,12 @@ public:
         arb_set(data_, other.data_);
     }
     
+    // Move constructor takes other limbs, other becomes zero.
+    ArbInterval(ArbInterval&& other)
+    : ArbInterval() {
+        swap(other);
+    }
+    
     ArbInterval(const Value& value)
     : ArbInterval() {
         arb_set_arf(data_, value.data_);
@@ -68,10 +76,14 @@ public:
         arb_swap(data_, other.data_);
     }
     
+    // Copy assignment reuses already allocated limbs.
     ArbInterval& operator=(const ArbInterval& other) {
-        ArbInterval temp(other);
-        swap(temp);
-        
+        arb_set(data_, other.data_);
+        return *this;
+    }
+    
+    ArbInterval& operator=(ArbInterval&& other) {
+        swap(other);
         return *this;
     }
     
@@ -91,9 +103,8 @@ public:
         return *this;
     }
     ArbInterval& operator*=(int x) {
-        slong s = x;
         arb_mul_si(data_, data_, x, getPrecision());
-    
+        return *this;
     }
     
     ArbInterval& operator/=(const ArbInterval& x) {
@@ -101,6 +112,18 @@ public:
         return *this;
     }
     
+    // Sets the interval to *this + x * y without a temporary.
+    ArbInterval& addmul(const ArbInterval& x, const ArbInterval& y) {
+        arb_addmul(data_, x.data_, y.data_, getPrecision());
+        return *this;
+    }
+    
+    // Sets the interval to *this - x * y without a temporary.
+    ArbInterval& submul(const ArbInterval& x, const ArbInterval& y) {
+        arb_submul(data_, x.data_, y.data_, getPrecision());
+        return *this;
+    }
+    
     // Sets the interval to its negation.
     void neg() {
         arb_neg(data_, data_);
@@ -138,6 +161,15 @@ public:
         return temp;
     }
     
+    // Returns right bound of absolute value of the interval as
+    // upward rounded magnitude.
+    Magnitude mag() const {
+        Magnitude temp;
+        arb_get_mag(temp.data(), data_);
+        
+        return temp;
+    }
+    
     // Sets the interval to zero.
     void zero() {
         arb_zero(data_);
@@ -150,6 +182,7 @@ public:
     
     // Returns data_ value. Need to refactor this.
     arb_t& data() { return data_; }
+    const arb_t& data() const { return data_; }
     
     // Comparision functions.
     bool eq(const ArbInterval& x) const { return (arb_eq(data_, x.data_)); }
@@ -198,39 +231,111 @@ inline bool operator>=(const ArbInterval& x, const ArbInterval& y) {
 }
 
 // Arithmetic operations.
-inline ArbInterval operator+(ArbInterval x, const ArbInterval& y) {
+// Operations with rvalue operand reuse its limbs for the result, so
+// expressions like a * b - c make only one temporary.
+inline ArbInterval operator+(const ArbInterval& x, const ArbInterval& y) {
+    ArbInterval z;
+    arb_add(z.data(), x.data(), y.data(), getPrecision());
+    return z;
+}
+
+inline ArbInterval operator+(ArbInterval&& x, const ArbInterval& y) {
+    x += y;
+    return std::move(x);
+}
+
+inline ArbInterval operator+(const ArbInterval& x, ArbInterval&& y) {
+    y += x;
+    return std::move(y);
+}
+
+inline ArbInterval operator+(ArbInterval&& x, ArbInterval&& y) {
     x += y;
-    return x;
+    return std::move(x);
+}
+
+inline ArbInterval operator-(const ArbInterval& x, const ArbInterval& y) {
+    ArbInterval z;
+    arb_sub(z.data(), x.data(), y.data(), getPrecision());
+    return z;
 }
 
-inline ArbInterval operator-(ArbInterval x, const ArbInterval& y) {
+inline ArbInterval operator-(ArbInterval&& x, const ArbInterval& y) {
     x -= y;
-    return x;
+    return std::move(x);
 }
 
-inline ArbInterval operator*(ArbInterval x, const ArbInterval& y) {
+inline ArbInterval operator-(const ArbInterval& x, ArbInterval&& y) {
+    arb_sub(y.data(), x.data(), y.data(), getPrecision());
+    return std::move(y);
+}
+
+inline ArbInterval operator-(ArbInterval&& x, ArbInterval&& y) {
+    x -= y;
+    return std::move(x);
+}
+
+inline ArbInterval operator*(const ArbInterval& x, const ArbInterval& y) {
+    ArbInterval z;
+    arb_mul(z.data(), x.data(), y.data(), getPrecision());
+    return z;
+}
+
+inline ArbInterval operator*(ArbInterval&& x, const ArbInterval& y) {
     x *= y;
-    return x;
+    return std::move(x);
+}
+
+inline ArbInterval operator*(const ArbInterval& x, ArbInterval&& y) {
+    y *= x;
+    return std::move(y);
 }
 
-inline ArbInterval operator/(ArbInterval x, const ArbInterval& y) {
+inline ArbInterval operator*(ArbInterval&& x, ArbInterval&& y) {
+    x *= y;
+    return std::move(x);
+}
+
+inline ArbInterval operator/(const ArbInterval& x, const ArbInterval& y) {
+    ArbInterval z;
+    arb_div(z.data(), x.data(), y.data(), getPrecision());
+    return z;
+}
+
+inline ArbInterval operator/(ArbInterval&& x, const ArbInterval& y) {
+    x /= y;
+    return std::move(x);
+}
+
+inline ArbInterval operator/(const ArbInterval& x, ArbInterval&& y) {
+    arb_div(y.data(), x.data(), y.data(), getPrecision());
+    return std::move(y);
+}
+
+inline ArbInterval operator/(ArbInterval&& x, ArbInterval&& y) {
     x /= y;
-    return x;
+    return std::move(x);
+}
+
+inline ArbInterval operator-(const ArbInterval& x) {
+    ArbInterval z;
+    arb_neg(z.data(), x.data());
+    return z;
 }
 
-inline ArbInterval operator-(ArbInterval x) {
+inline ArbInterval operator-(ArbInterval&& x) {
     x.neg();
-    return x;
+    return std::move(x);
 }
 
 // To stream.
-std::ostream& operator<<(std::ostream& os, const ArbInterval& x) {
+inline std::ostream& operator<<(std::ostream& os, const ArbInterval& x) {
     os << arb_get_str(x.data_, 10, ARB_STR_MORE);
     return os;
 }
 
 // Outer swap function.
-void swap(ArbInterval& x, ArbInterval& y) {
+inline void swap(ArbInterval& x, ArbInterval& y) {
     x.swap(y);
 }
 
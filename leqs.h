@@ -2,63 +2,73 @@
 #define LEQS_H
 
 #include "apost_statical.h"
+#include "crout.h"
 #include "gauss.h"
 #include "interval.h"
 #include "matrix.h"
+#include "verify.h"
 
 namespace interval {
 
-// Solves the linear equation system using Gauss elimination method
-// for aposteriori ProxyInterval values (withoud pivoting).
+// Computes the solution of eliminated linear equation system M
+// (the result of gauss_elimination()).
 template<class IntervalT>
-Matrix<apost::ProxyIntervalResult> linear_solve_apost(Matrix<IntervalT> M) {
+Matrix<IntervalT> back_substitution(const Matrix<IntervalT>& M) {
     size_t n = M.nrow();
-
-    gauss_elimination(M);
     
-    Matrix<apost::ProxyIntervalResult> x(n, 1);
-    Matrix<IntervalT> temp(n, 1);
+    Matrix<IntervalT> x(n, 1);
+    IntervalT t;
     for (int i = n - 1; i >= 0; --i) {
-        temp.at(i, 0) = M.at(i, n);
+        x.at(i, 0) = M.at(i, n);
         for (int j = i + 1; j < n; ++j) {
-            IntervalT t = M.at(i, j) * temp.at(j, 0);
-            temp.at(i, 0) = temp.at(i, 0) - t;
+            t = M.at(i, j);
+            t *= x.at(j, 0);
+            x.at(i, 0) -= t;
         }
-        
-        temp.at(i, 0) = temp.at(i, 0) / M.at(i, i);
-        x.at(i, 0) = temp.at(i, 0);
+        x.at(i, 0) = x.at(i, 0) / M.at(i, i);
     }
-    
+
     return x;
 }
 
+// Solves the linear equation system using Gauss elimination method
+// for aposteriori ProxyInterval values (withoud pivoting). Elimination
+// and back substitution are recorded as matrix nodes (apost_matrix.h).
+template<class IntervalT>
+Matrix<apost::ProxyIntervalResult> linear_solve_apost(Matrix<IntervalT> M) {
+    gauss_elimination(M);
+    
+    // errors of all solution components in one reverse pass
+    return apost::evaluate(back_substitution(M));
+}
+
 // Solves the linear equation system using Gauss elimination method
 // (withoud pivoting). Can't be used with dynamic aposteriori method due to 
 // many output values.
 template<class IntervalT>
 Matrix<IntervalT> linear_solve(Matrix<IntervalT> M) {
-    size_t n = M.nrow();
-
     gauss_elimination(M);
     
-    Matrix<IntervalT> x(n, 1);
-    for (int i = n - 1; i >= 0; --i) {
-        x.at(i, 0) = M.at(i, n);
-        for (int j = i + 1; j < n; ++j) {
-            x.at(i, 0) = x.at(i, 0) - M.at(i, j) * x.at(j, 0);
-        }
-        x.at(i, 0) = x.at(i, 0) / M.at(i, i);
-    }
+    return back_substitution(M);
+}
 
-    return x;
+// The same as linear_solve(M), the elimination is performed in work
+// matrix. Its elements are reused if it has the same size as M.
+template<class IntervalT>
+Matrix<IntervalT> linear_solve(const Matrix<IntervalT>& M,
+        Matrix<IntervalT>& work) {
+    work = M;
+    gauss_elimination(work);
+    
+    return back_substitution(work);
 }
 
 // Computes the solution of system of linear equations using Gaussian
 // elimination (with pivoting) and statical implementation
-// of aposteriori method.
-Matrix<ArbInterval> leq_inv(Matrix<ArbInterval> M) {
-    Matrix<ArbInterval> init = M;
-
+// of aposteriori method. The elimination is performed in work matrix,
+// its elements are reused if it has the same size as M.
+inline Matrix<ArbInterval> leq_inv(const Matrix<ArbInterval>& M,
+        Matrix<ArbInterval>& work) {
     size_t n = M.nrow();
     size_t m = M.ncol();
     
@@ -74,39 +84,76 @@ Matrix<ArbInterval> leq_inv(Matrix<ArbInterval> M) {
         return Matrix<ArbInterval>(1, 1, 0);
     }
 
-    Matrix<ArbInterval> xs = linear_solve(M);
-    gauss_elimination(M);
+    // one factorization for the solution and its errors
+    work = M;
+    gauss_elimination(work);
+    Matrix<ArbInterval> xs = back_substitution(work);
 
-    for (int c = 0; c < n; ++c) {
+    // errors of all components in one pass
+    std::vector<Value> errors = ComputeSolveErrors(M, work, xs);
+    for (size_t c = 0; c < n; ++c) {
+        xs.at(c, 0) = ArbInterval(xs.at(c, 0).val(), errors[c]);
+    }
     
-        ArbInterval f = xs.at(c, 0);
-        ArbInterval x = f;
-        Matrix<ArbInterval> dM(n, m, 0);
-        ArbInterval df = 1;
-        
-        Matrix<ArbInterval> dxs(n, 1, 0);
-        dxs.at(c, 0) = 1;
-
-        for (int i = c; i <= n - 1; ++i) {
-            ArbInterval t = xs.at(i, 0) * M.at(i, i);
-            ArbInterval dt = dxs.at(i, 0) / M.at(i, i);
-            dM.at(i, i) -= xs.at(i, 0) * dxs.at(i, 0) / M.at(i, i);
-            dM.at(i, n) = dt;
-            
-            for (int j = n - 1; j >= i + 1; --j) {
-                ArbInterval z = M.at(i, j) * xs.at(j, 0);
-                t = t + z;
-                
-                dM.at(i, j) -= xs.at(j, 0) * dt;
-                dxs.at(j, 0) -= M.at(i, j) * dt;
-            }
-        }
+    return xs;
+}
+
+inline Matrix<ArbInterval> leq_inv(const Matrix<ArbInterval>& M) {
+    Matrix<ArbInterval> work;
+    return leq_inv(M, work);
+}
+
+// Splits n*m system matrix M into n*n matrix A and n*(m-n) right-hand
+// sides b.
+inline void split_system(const Matrix<ArbInterval>& M, Matrix<ArbInterval>& A,
+        Matrix<ArbInterval>& b) {
+    size_t n = M.nrow();
+    size_t m = M.ncol();
     
-        GaussInverse(M, dM);
-        xs.at(c, 0) = ArbInterval(x.val(), ComputeError(init, dM));
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j)
+            A.at(i, j) = M.at(i, j);
+        for (size_t j = n; j < m; ++j)
+            b.at(i, j - n) = M.at(i, j);
     }
+}
+
+// Solves the linear equation system with verified method (see verify.h):
+// approximate inverse in double precision and Krawczyk enclosure of
+// the solution. If the solution can not be verified, uses linear_solve().
+inline Matrix<ArbInterval> linear_solve_verified(const Matrix<ArbInterval>& M) {
+    size_t n = M.nrow();
+    size_t m = M.ncol();
     
-    return xs;
+    Matrix<ArbInterval> A(n, n);
+    Matrix<ArbInterval> b(n, m - n);
+    split_system(M, A, b);
+    
+    Matrix<ArbInterval> x(n, m - n);
+    if (!solve_verified(A, b, x)) {
+        return linear_solve(M);
+    }
+    
+    return x;
+}
+
+// Solves the linear equation system with mixed-precision iterative
+// refinement (see solve_refined()). If the solution can not be verified,
+// uses linear_solve().
+inline Matrix<ArbInterval> linear_solve_refined(const Matrix<ArbInterval>& M) {
+    size_t n = M.nrow();
+    size_t m = M.ncol();
+    
+    Matrix<ArbInterval> A(n, n);
+    Matrix<ArbInterval> b(n, m - n);
+    split_system(M, A, b);
+    
+    Matrix<ArbInterval> x(n, m - n);
+    if (!solve_refined(A, b, x)) {
+        return linear_solve(M);
+    }
+    
+    return x;
 }
 
 }  // namespace interval
@@ -0,0 +1,160 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+
+#ifndef LU_H
+#define LU_H
+
+#include "apost_statical.h"
+#include "crout.h"
+#include "gauss.h"
+#include "interval.h"
+#include "matrix.h"
+
+#include <vector>
+
+/*
+    This file contains LUFactorization class - factorization P A = L U
+    of n*n interval matrix, which is computed once and used to solve
+    linear equation systems with many right-hand sides.
+
+    Each right-hand side costs O(n^2). Solution components carry statical
+    aposteriori errors
+        err x_c = sum_i |A^{-1}_ci| (err b_i + sum_j err A_ij |x_j|),
+    |A^{-1}| is computed from the stored factors once, in constructor.
+*/
+
+namespace interval {
+
+class LUFactorization {
+public:
+    // Factorizes n*n matrix A using gauss_elimination_pivot().
+    explicit LUFactorization(const Matrix<ArbInterval>& A)
+    : lu_(A)
+    , sign_(1)
+    , inverse_(0, 0)
+    , radii_(A.nrow(), A.ncol()) {
+        size_t n = A.nrow();
+        
+        sign_ = gauss_elimination_pivot(lu_, perm_);
+        permute_rows(lu_, perm_);
+        
+        // |A^{-1}|^T with rows in pivot order, see solve()
+        inverse_ = InverseTranspose(lu_);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                inverse_.at(i, j).abs();
+                radii_.at(i, j) = ArbInterval(A.at(i, j).error());
+            }
+        }
+    }
+    
+    // Matrix dimension.
+    size_t size() const { return lu_.nrow(); }
+    
+    // Packed factors of P A: L with unit diagonal below it, U above.
+    const Matrix<ArbInterval>& lu() const { return lu_; }
+    
+    // Row permutation, i-th row of P A is row perm()[i] of A.
+    const std::vector<int>& perm() const { return perm_; }
+    
+    // Returns (-1)^(number of permutations).
+    int sign() const { return sign_; }
+    
+    // Solves A X = B for n*k matrix B. Components of X have
+    // apost computed errors.
+    Matrix<ArbInterval> solve(const Matrix<ArbInterval>& B) const {
+        size_t n = size();
+        size_t k = B.ncol();
+        
+        Matrix<ArbInterval> X(n, k);
+        
+        // L Y = P B, U X = Y
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t c = 0; c < k; ++c) {
+                X.at(i, c) = B.at(perm_[i], c);
+            }
+        }
+        solve_unit_lower(lu_, X);
+        solve_upper(lu_, X);
+        
+        // W = err B + err A |X|
+        Matrix<ArbInterval> Xabs = X;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t c = 0; c < k; ++c) {
+                Xabs.at(i, c).abs();
+            }
+        }
+        
+        Matrix<ArbInterval> W(n, k);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t c = 0; c < k; ++c) {
+                W.at(i, c) = ArbInterval(B.at(i, c).error());
+            }
+            for (size_t j = 0; j < n; ++j) {
+                addmul_row(&W.at(i, 0), radii_.at(i, j), &Xabs.at(j, 0), k);
+            }
+        }
+        
+        // E = |A^{-1}| W, A^{-1}_ci = inverse_(m, c) for i = perm_[m]
+        Matrix<ArbInterval> E(n, k);
+        for (size_t m = 0; m < n; ++m) {
+            const ArbInterval* w = &W.at(perm_[m], 0);
+            for (size_t c = 0; c < n; ++c) {
+                addmul_row(&E.at(c, 0), inverse_.at(m, c), w, k);
+            }
+        }
+        
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t c = 0; c < k; ++c) {
+                const ArbInterval& e = E.at(i, c);
+                X.at(i, c) = ArbInterval(X.at(i, c).val(), e.val() + e.error());
+            }
+        }
+        
+        return X;
+    }
+    
+    // Solves A x = b.
+    std::vector<ArbInterval> solve(const std::vector<ArbInterval>& b) const {
+        size_t n = size();
+        
+        Matrix<ArbInterval> B(n, 1);
+        for (size_t i = 0; i < n; ++i) {
+            B.at(i, 0) = b[i];
+        }
+        
+        Matrix<ArbInterval> X = solve(B);
+        
+        std::vector<ArbInterval> x(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i].swap(X.at(i, 0));
+        }
+        
+        return x;
+    }
+    
+private:
+    Matrix<ArbInterval> lu_;
+    std::vector<int> perm_;
+    int sign_;
+    
+    // |A^{-T}| with rows permuted as rows of P A
+    Matrix<ArbInterval> inverse_;
+    // errors of A elements
+    Matrix<ArbInterval> radii_;
+    
+    // y[k] = y[k] + z * x[k] for k = 0, ..., count - 1.
+    static void addmul_row(ArbInterval* y, const ArbInterval& z,
+            const ArbInterval* x, size_t count) {
+        for (size_t k = 0; k < count; ++k) {
+            y[k].addmul(z, x[k]);
+        }
+    }
+};
+
+}  // namespace interval
+
+#endif  // LU_H
@@ -0,0 +1,131 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+#ifndef MAGNITUDE_H
+#define MAGNITUDE_H
+
+#include "value.h"
+
+#include "flint/mag.h"
+
+#include <iostream>
+
+/*
+    This file contains  C++ wrapper of Arb library mag_t type for unsigned
+    floating-point upper bounds representation. All operations are rounded
+    upwards, so the result is always an upper bound of the exact one.
+*/
+
+namespace interval {
+
+// Class to work with upper bounds of absolute values and errors.
+class Magnitude {
+public:
+
+    // Constructors.
+    Magnitude() {
+        mag_init(data_);
+    }
+
+    Magnitude(double value)
+    : Magnitude() {
+        mag_set_d(data_, value);
+    }
+
+    // Upper bound of abs(value).
+    Magnitude(const Value& value)
+    : Magnitude() {
+        arf_get_mag(data_, value.data_);
+    }
+
+    Magnitude(const Magnitude& other)
+    : Magnitude() {
+        mag_set(data_, other.data_);
+    }
+
+    // Destructor.
+    ~Magnitude() {
+        mag_clear(data_);
+    }
+
+    // Swap and assignment.
+    void swap(Magnitude& other) {
+        mag_swap(data_, other.data_);
+    }
+
+    Magnitude& operator=(const Magnitude& other) {
+        mag_set(data_, other.data_);
+        return *this;
+    }
+
+    // Arithmetical operations.
+    Magnitude& operator+=(const Magnitude& x) {
+        mag_add(data_, data_, x.data_);
+        return *this;
+    }
+
+    Magnitude& operator*=(const Magnitude& x) {
+        mag_mul(data_, data_, x.data_);
+        return *this;
+    }
+
+    // Sets the magnitude to *this + x * y.
+    Magnitude& addmul(const Magnitude& x, const Magnitude& y) {
+        mag_addmul(data_, x.data_, y.data_);
+        return *this;
+    }
+
+    // Sets the magnitude to zero.
+    void zero() {
+        mag_zero(data_);
+    }
+
+    // Returns exact Value representation.
+    Value val() const {
+        Value temp;
+        arf_set_mag(temp.data_, data_);
+
+        return temp;
+    }
+
+    // Returns data_ value.
+    mag_t& data() { return data_; }
+    const mag_t& data() const { return data_; }
+
+    // Comparision functions.
+    bool lt(const Magnitude& x) const { return mag_cmp(data_, x.data_) < 0; }
+    bool gt(const Magnitude& x) const { return mag_cmp(data_, x.data_) > 0; }
+
+private:
+    mag_t data_;
+};
+
+inline bool operator<(const Magnitude& x, const Magnitude& y) {
+    return x.lt(y);
+}
+
+inline bool operator>(const Magnitude& x, const Magnitude& y) {
+    return x.gt(y);
+}
+
+// To stream.
+inline std::ostream& operator<<(std::ostream& os, const Magnitude& x) {
+    os << static_cast<double>(x.val());
+    return os;
+}
+
+inline Magnitude operator+(Magnitude x, const Magnitude& y) {
+    x += y;
+    return x;
+}
+
+inline Magnitude operator*(Magnitude x, const Magnitude& y) {
+    x *= y;
+    return x;
+}
+
+}  // namespace interval
+
+#endif  // MAGNITUDE_H
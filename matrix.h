@@ -12,7 +12,8 @@
 /*
     This file contains class to work with matrices.
     This is not implemented any matrix operations. Only element access 
-    and print functions.
+    and print functions. Matrix<ArbInterval> is stored in FLINT arb_mat_t,
+    see arb_matrix.h.
 */
 
 namespace interval {
@@ -21,6 +22,12 @@ namespace interval {
 template<class IntervalT>
 class Matrix {
 public:
+    // Constructed 0*0 matrix.
+    Matrix()
+    : nrow_(0)
+    , ncol_(0) {
+    }
+    
     // Constructed nrow*ncol matrix. Sets all elements to 0.
     Matrix(int nrow, int ncol)
     : nrow_(nrow)
@@ -54,7 +61,7 @@ public:
         return data_[r * ncol_ + c];
     }
     
-    IntervalT at(int r, int c) const {
+    const IntervalT& at(int r, int c) const {
         return data_[r * ncol_ + c];
     }
     
@@ -81,5 +88,8 @@ std::ostream& operator<<(std::ostream& os, const Matrix<IntervalT>& x) {
 
 }  // namespace interval
 
+// Matrix<ArbInterval> specialization.
+#include "arb_matrix.h"
+
 #endif  // MATRIX_H
 
@@ -6,22 +6,79 @@
 #ifndef PRECISION_H
 #define PRECISION_H
 
-// Now all calculations are made with PRECISION precision (in bits).
+#include <atomic>
+
+/*
+    All calculations are made with getPrecision() precision (in bits).
+
+    There is one default precision shared by all translation units and
+    threads (setPrecision). A thread can override it for its own
+    computations with PrecisionScope object, e.g. to run a cheap low
+    precision pass and a precise final step, or to run workers at
+    different precisions at the same time.
+*/
 
 namespace interval {
 
-static int PRECISION = 256;
+namespace precision {
 
+// Default precision.
+inline std::atomic<int>& global() {
+    static std::atomic<int> value(256);
+    return value;
+}
+
+// Precision of the current thread, 0 if the default one is used.
+inline int& local() {
+    thread_local int value = 0;
+    return value;
+}
+
+}  // namespace precision
+
+// Sets the default precision. Threads inside PrecisionScope keep
+// their own precision.
 inline void setPrecision(int precision) {
-    PRECISION = precision;
+    precision::global().store(precision, std::memory_order_relaxed);
 }
 
 inline int getPrecision() {
-    return PRECISION;
+    int precision = precision::local();
+    return precision ? precision
+                     : precision::global().load(std::memory_order_relaxed);
 }
 
+/*
+    Sets the precision of the current thread while the object is alive,
+    the previous one is restored by destructor. Scopes can be nested.
+    Zero precision leaves the current precision unchanged.
+    
+        {
+            PrecisionScope scope(64);
+            Matrix<ArbInterval> x = linear_solve(M);   // 64 bits
+        }
+*/
+class PrecisionScope {
+public:
+    explicit PrecisionScope(int precision)
+    : saved_(precision::local()) {
+        if (precision) {
+            precision::local() = precision;
+        }
+    }
+    
+    ~PrecisionScope() {
+        precision::local() = saved_;
+    }
+    
+    PrecisionScope(const PrecisionScope&) = delete;
+    PrecisionScope& operator=(const PrecisionScope&) = delete;
+    
+private:
+    int saved_;
+};
+
 }  // namespace interval
 
 
 #endif  // PRECISION_H
-
@@ -50,11 +50,9 @@ Matrix<ArbInterval> random_matrix(size_t n, size_t error_bound,
         for (size_t j = 0; j < n; ++j)
             mag_set(arb_radref(arb_mat_entry(B, i, j)), error);
     
+    // B becomes the result matrix without copying
     Matrix<ArbInterval> result(n, n);
-    
-    for (size_t i = 0; i < n; ++i)
-        for (size_t j = 0; j < n; ++j)
-            arb_set(result.at(i, j).data(), arb_mat_entry(B, i, j));
+    arb_mat_swap(result.data(), B);
 
     mag_clear(error);
     arb_mat_clear(B);
@@ -0,0 +1,322 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+
+#ifndef TAPE_FILE_H
+#define TAPE_FILE_H
+
+#include "double_interval.h"
+#include "interval.h"
+#include "magnitude.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+/*
+    This file contains binary files of Controller reverse commands (tapes)
+    for computations whose commands do not fit in memory, see
+    Controller::spill().
+
+    TapeWriter appends records to the file during computation through
+    a large stdio buffer, the file is only appended. TapeReader maps the
+    file to memory and reads records from the end to the beginning, as
+    the reverse pass needs them. The kernel readahead is forward, so the
+    reader asks for the next (lower) window of the file in advance and
+    releases windows which are already read.
+
+    File layout:
+        TapeHeader
+        records: payload (length bytes), TapeRecord
+    The fixed size part of a record is after its payload, so records can
+    be read backward. Payload is the coefficient of corr or the rounding
+    error of rnull command. ArbInterval and Magnitude payloads are FLINT
+    dump strings (exact and portable), a tape can be evaluated later
+    by another process (see Controller::load()).
+*/
+
+namespace interval {
+
+namespace apost {
+
+// Tape file format version.
+const uint32_t kTapeVersion = 1;
+// Buffer of TapeWriter.
+const size_t kTapeBuffer = 1 << 20;
+// Readahead window of TapeReader.
+const size_t kTapeWindow = 1 << 24;
+
+struct TapeHeader {
+    char magic[8];          // "APOSTTAP"
+    uint32_t version;
+    uint32_t mode;          // Controller::Mode of corr coefficients
+    int64_t precision;      // Controller precision
+    uint64_t size;          // number of memory elements
+    uint64_t nodes;         // number of nodes (they are not saved)
+};
+
+struct TapeRecord {
+    uint64_t addr;
+    uint64_t coef;          // node index of node command
+    uint32_t length;        // payload length
+    uint8_t op;             // Controller::Opcode
+    uint8_t pad[3];
+};
+
+// Payload serialization. Strings are saved with terminating zero,
+// so they are loaded from the mapped file in place. load() returns false
+// if the payload is not a dump of the type.
+inline void dump(const ArbInterval& x, std::string& payload) {
+    char* str = arb_dump_str(x.data());
+    payload.assign(str, std::strlen(str) + 1);
+    flint_free(str);
+}
+
+inline bool load(const char* payload, size_t length, ArbInterval& x) {
+    return length != 0 && payload[length - 1] == '\0' &&
+           arb_load_str(x.data(), payload) == 0;
+}
+
+inline void dump(const Magnitude& x, std::string& payload) {
+    char* str = mag_dump_str(x.data());
+    payload.assign(str, std::strlen(str) + 1);
+    flint_free(str);
+}
+
+inline bool load(const char* payload, size_t length, Magnitude& x) {
+    return length != 0 && payload[length - 1] == '\0' &&
+           mag_load_str(x.data(), payload) == 0;
+}
+
+inline void dump(const DoubleInterval& x, std::string& payload) {
+    double data[2] = {x.mid(), x.rad()};
+    payload.assign(reinterpret_cast<const char*>(data), sizeof(data));
+}
+
+inline bool load(const char* payload, size_t length, DoubleInterval& x) {
+    double data[2];
+    if (length != sizeof(data)) {
+        return false;
+    }
+
+    std::memcpy(data, payload, sizeof(data));
+    x = DoubleInterval(data[0], data[1]);
+    return true;
+}
+
+// Appends records to tape file.
+class TapeWriter {
+public:
+    // Creates file at path (an existing one is truncated).
+    TapeWriter(const std::string& path, uint32_t mode, int precision)
+    : path_(path)
+    , file_(std::fopen(path.c_str(), "w+b"))
+    , failed_(false) {
+        std::memset(&header_, 0, sizeof(header_));
+        std::memcpy(header_.magic, "APOSTTAP", 8);
+        header_.version = kTapeVersion;
+        header_.mode = mode;
+        header_.precision = precision;
+
+        if (file_) {
+            std::setvbuf(file_, nullptr, _IOFBF, kTapeBuffer);
+            write(&header_, sizeof(header_));
+        }
+    }
+
+    ~TapeWriter() {
+        if (file_) {
+            std::fclose(file_);
+        }
+    }
+
+    TapeWriter(const TapeWriter&) = delete;
+    TapeWriter& operator=(const TapeWriter&) = delete;
+
+    // Returns false if the file was not created or some write failed
+    // (e.g. the disk is full).
+    bool good() const { return file_ && !failed_; }
+
+    const std::string& path() const { return path_; }
+
+    // Appends record without payload.
+    void push(uint8_t op, size_t addr, size_t coef) {
+        TapeRecord record = {addr, coef, 0, op, {0, 0, 0}};
+        write(&record, sizeof(record));
+    }
+
+    // Appends record with payload x.
+    template<class T>
+    void push(uint8_t op, size_t addr, size_t coef, const T& x) {
+        dump(x, payload_);
+        write(payload_.data(), payload_.size());
+
+        TapeRecord record = {addr, coef,
+                             static_cast<uint32_t>(payload_.size()), op,
+                             {0, 0, 0}};
+        write(&record, sizeof(record));
+    }
+
+    // Writes buffered records to the file and updates its header:
+    // size - number of memory elements, nodes - number of nodes.
+    // Returns false if the tape is not completely written.
+    bool flush(size_t size, size_t nodes) {
+        header_.size = size;
+        header_.nodes = nodes;
+
+        failed_ = failed_ || std::fseek(file_, 0, SEEK_SET) != 0;
+        write(&header_, sizeof(header_));
+        failed_ = failed_ || std::fseek(file_, 0, SEEK_END) != 0 ||
+                  std::fflush(file_) != 0;
+
+        return good();
+    }
+
+private:
+    std::string path_;
+    std::FILE* file_;
+    TapeHeader header_;
+    std::string payload_;
+    // some write failed, the tape is not valid
+    bool failed_;
+
+    void write(const void* data, size_t size) {
+        if (!failed_ && std::fwrite(data, 1, size, file_) != size) {
+            failed_ = true;
+        }
+    }
+};
+
+// Reads records of tape file from the end.
+class TapeReader {
+public:
+    explicit TapeReader(const std::string& path)
+    : data_(nullptr)
+    , size_(0)
+    , position_(0)
+    , window_(0)
+    , resident_(0)
+    , corrupted_(false) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) == 0 &&
+                static_cast<size_t>(info.st_size) >= sizeof(TapeHeader)) {
+            void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE,
+                              fd, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<char*>(data);
+                size_ = info.st_size;
+                madvise(data_, size_, MADV_RANDOM);
+            }
+        }
+        // the mapping is valid after close
+        close(fd);
+
+        if (data_) {
+            std::memcpy(&header_, data_, sizeof(header_));
+            if (std::memcmp(header_.magic, "APOSTTAP", 8) != 0 ||
+                    header_.version != kTapeVersion) {
+                munmap(data_, size_);
+                data_ = nullptr;
+                size_ = 0;
+            }
+        }
+
+        position_ = size_;
+        window_ = size_;
+        resident_ = size_;
+    }
+
+    ~TapeReader() {
+        if (data_) {
+            munmap(data_, size_);
+        }
+    }
+
+    TapeReader(const TapeReader&) = delete;
+    TapeReader& operator=(const TapeReader&) = delete;
+
+    // Returns false if the file is not a tape.
+    bool good() const { return data_ != nullptr; }
+
+    const TapeHeader& header() const { return header_; }
+
+    // Reads the record before the current position and its payload.
+    // Returns false at the beginning of records or if the record does
+    // not fit in the file (see corrupted()).
+    bool previous(TapeRecord& record, const char*& payload) {
+        if (position_ < sizeof(TapeHeader) + sizeof(TapeRecord)) {
+            corrupted_ = position_ != sizeof(TapeHeader);
+            return false;
+        }
+
+        position_ -= sizeof(TapeRecord);
+        prefetch(position_);
+        std::memcpy(&record, data_ + position_, sizeof(record));
+
+        if (record.length > position_ - sizeof(TapeHeader)) {
+            corrupted_ = true;
+            return false;
+        }
+
+        position_ -= record.length;
+        prefetch(position_);
+        payload = data_ + position_;
+
+        return true;
+    }
+
+    // Returns true if records of the file are truncated or overlap
+    // the header. It is set by previous().
+    bool corrupted() const { return corrupted_; }
+
+private:
+    char* data_;
+    size_t size_;
+    TapeHeader header_;
+
+    size_t position_;
+    // [window_, resident_) are pages asked or read by the reader
+    size_t window_;
+    size_t resident_;
+    bool corrupted_;
+
+    // Asks the window of kTapeWindow bytes below position, when position
+    // leaves the current one. Pages above the previous window are
+    // released, they are not read again.
+    void prefetch(size_t position) {
+        if (position >= window_) {
+            return;
+        }
+
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t end = window_;
+        window_ = position > kTapeWindow ?
+            (position - kTapeWindow) / page * page : 0;
+        madvise(data_ + window_, end - window_, MADV_WILLNEED);
+
+        size_t keep = (end + page - 1) / page * page + kTapeWindow;
+        if (keep < resident_) {
+            madvise(data_ + keep, resident_ - keep, MADV_DONTNEED);
+            resident_ = keep;
+        }
+    }
+};
+
+}  // namespace apost
+
+}  // namespace interval
+
+#endif  // TAPE_FILE_H
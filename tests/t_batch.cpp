@@ -0,0 +1,68 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+#include "../batch.h"
+#include "../random_matrix.h"
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+/*
+    This file contains test of batch drivers: results are in input order
+    and an exception of one problem is rethrown to the caller, the pool
+    can be used after it.
+*/
+
+using namespace interval;
+
+int main() {
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> distribution(-5, 5);
+    auto random = [&] () { return distribution(generator); };
+
+    std::vector<Matrix<ArbInterval>> problems;
+    for (size_t i = 0; i < 64; ++i) {
+        problems.push_back(random_matrix(1 + i % 6, 8, random));
+    }
+
+    int failures = 0;
+    for (size_t nthreads : {1, 4}) {
+        ThreadPool pool(nthreads);
+
+        // the 10-th problem fails
+        auto kernel = [&] (const Matrix<ArbInterval>& M,
+                           batch::Workspace& workspace) {
+            if (&M == &problems[10]) {
+                throw std::out_of_range("bad matrix");
+            }
+            return det_pivot(M, workspace.work);
+        };
+
+        bool thrown = false;
+        try {
+            solve_batch<ArbInterval>(problems, kernel, pool);
+        } catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        if (!thrown) {
+            std::cout << nthreads << " threads: exception is lost\n";
+            ++failures;
+        }
+
+        std::vector<ArbInterval> dets = det_pivot_batch(problems, pool);
+        for (size_t i = 0; i < problems.size(); ++i) {
+            ArbInterval d = det_pivot(problems[i]);
+            if (dets[i].val() != d.val() || dets[i].error() != d.error()) {
+                std::cout << nthreads << " threads: result " << i
+                          << " differs\n";
+                ++failures;
+            }
+        }
+    }
+
+    std::cout << (failures == 0 ? "OK" : "FAILED") << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+#include "../crout.h"
+#include "../random_matrix.h"
+
+#include <iostream>
+#include <random>
+
+/*
+    This file contains test of blocked lu_crout(): the factors enclose
+    the permuted matrix, and tasks on several threads give the same
+    results as one thread.
+*/
+
+using namespace interval;
+
+// Returns true if elements of x and y have the same midpoints and radii.
+bool same(const Matrix<ArbInterval>& x, const Matrix<ArbInterval>& y) {
+    for (size_t i = 0; i < x.nrow(); ++i) {
+        for (size_t j = 0; j < x.ncol(); ++j) {
+            if (!arb_equal(x.at(i, j).data(), y.at(i, j).data())) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Returns true if (L U)_ij - A_{perm[i], j} contains zero for the first
+// n columns: lu is the result of lu_crout() with pivoting, its i-th
+// row of factors is row perm[i].
+bool encloses(const Matrix<ArbInterval>& lu, const Matrix<ArbInterval>& a,
+        const std::vector<int>& perm) {
+    size_t n = lu.nrow();
+    for (size_t i = 0; i < n; ++i) {
+        const ArbInterval* l = &lu.at(perm[i], 0);
+        for (size_t j = 0; j < n; ++j) {
+            ArbInterval x = i <= j ? l[j] : l[j] * lu.at(perm[j], j);
+            for (size_t r = 0; r < std::min(i, j); ++r) {
+                x += l[r] * lu.at(perm[r], j);
+            }
+            x -= a.at(perm[i], j);
+            if (!x.contains_zero()) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main() {
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<double> distribution(-5, 5);
+    auto random = [&] () { return distribution(generator); };
+
+    ThreadPool pool(4);
+    ThreadPool single(1);
+
+    int failures = 0;
+    for (size_t n : {1, 7, 16, 17, 40, 73}) {
+        for (size_t extra : {0, 3}) {
+            Matrix<ArbInterval> a = random_matrix(n, 8, random);
+            Matrix<ArbInterval> augmented(n, n + extra);
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j < n + extra; ++j) {
+                    augmented.at(i, j) = j < n ? a.at(i, j) :
+                                                 ArbInterval(random(), 1e-8);
+                }
+            }
+
+            Matrix<ArbInterval> parallel = augmented;
+            Matrix<ArbInterval> serial = augmented;
+            std::vector<int> perm;
+            std::vector<int> serial_perm;
+            int sign = lu_crout(parallel, &perm, pool);
+            int serial_sign = lu_crout(serial, &serial_perm, single);
+
+            if (sign != serial_sign || perm != serial_perm ||
+                    !same(parallel, serial)) {
+                std::cout << "n = " << n << ", extra = " << extra
+                          << ": threads change results\n";
+                ++failures;
+            }
+
+            if (!encloses(parallel, augmented, perm)) {
+                std::cout << "n = " << n << ", extra = " << extra
+                          << ": LU does not enclose matrix\n";
+                ++failures;
+            }
+        }
+    }
+
+    std::cout << (failures == 0 ? "OK" : "FAILED") << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+#include "../apost.h"
+#include "../dets.h"
+#include "../leqs.h"
+#include "../random_matrix.h"
+
+#include <iostream>
+#include <random>
+
+/*
+    This file contains test of matrix nodes (apost_matrix.h): apost errors
+    of det_pivot() and linear_solve_apost() computed with LU and triangular
+    solve nodes agree with errors of the same computations recorded as
+    scalar operations (gauss.h and leqs.h templates).
+*/
+
+using namespace interval;
+using namespace apost;
+
+typedef ProxyInterval<ArbInterval> Proxy;
+
+// Relative difference of node and scalar errors allowed by the test.
+const double kTolerance = 0.01;
+
+// Returns true if node error agrees with scalar error.
+bool agree(const ArbInterval& node, const ArbInterval& scalar) {
+    double x = node.error();
+    double y = scalar.error();
+    return std::isfinite(x) && std::isfinite(y) &&
+           std::fabs(x - y) <= kTolerance * std::max(x, y);
+}
+
+// Returns matrix of ProxyInterval values of the current controller.
+Matrix<Proxy> proxy(const Matrix<ArbInterval>& M) {
+    Matrix<Proxy> result(M.nrow(), M.ncol());
+    for (size_t i = 0; i < M.nrow(); ++i) {
+        for (size_t j = 0; j < M.ncol(); ++j) {
+            result.at(i, j) = M.at(i, j);
+        }
+    }
+
+    return result;
+}
+
+// Returns apost det_pivot(M), matrix is eliminated by LU node.
+ArbInterval det_node(const Matrix<ArbInterval>& M) {
+    Controller<ArbInterval> controller;
+    ControllerScope<ArbInterval> scope(controller);
+
+    Matrix<Proxy> A = proxy(M);
+    controller.init();
+    Proxy d = det_pivot(A);
+
+    return controller.evaluate(std::vector<size_t>(1, d.addr()))[0];
+}
+
+// Returns apost det_pivot(M) recorded as scalar operations.
+ArbInterval det_scalar(const Matrix<ArbInterval>& M) {
+    Controller<ArbInterval> controller;
+    ControllerScope<ArbInterval> scope(controller);
+
+    Matrix<Proxy> A = proxy(M);
+    controller.init();
+    std::vector<int> perm;
+    int sign = gauss_elimination_pivot<Proxy>(A, perm);
+    Proxy d = A.at(perm[0], 0);
+    for (size_t i = 1; i < A.nrow(); ++i) {
+        d = d * A.at(perm[i], i);
+    }
+    d = Proxy(ArbInterval(sign)) * d;
+
+    return controller.evaluate(std::vector<size_t>(1, d.addr()))[0];
+}
+
+// Returns apost solution of n*(n+1) system M computed by nodes.
+std::vector<ArbInterval> solve_node(const Matrix<ArbInterval>& M) {
+    Controller<ArbInterval> controller;
+    ControllerScope<ArbInterval> scope(controller);
+
+    Matrix<Proxy> A = proxy(M);
+    controller.init();
+    Matrix<ProxyIntervalResult> x = linear_solve_apost(A);
+
+    std::vector<ArbInterval> result;
+    for (size_t i = 0; i < x.nrow(); ++i) {
+        result.push_back(x.at(i, 0));
+    }
+
+    return result;
+}
+
+// Returns apost solution of n*(n+1) system M recorded as scalar
+// operations.
+std::vector<ArbInterval> solve_scalar(const Matrix<ArbInterval>& M) {
+    Controller<ArbInterval> controller;
+    ControllerScope<ArbInterval> scope(controller);
+
+    Matrix<Proxy> A = proxy(M);
+    controller.init();
+    gauss_elimination<Proxy>(A);
+    Matrix<Proxy> x = back_substitution<Proxy>(A);
+
+    std::vector<size_t> outputs;
+    for (size_t i = 0; i < x.nrow(); ++i) {
+        outputs.push_back(x.at(i, 0).addr());
+    }
+
+    return controller.evaluate(outputs);
+}
+
+int main() {
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> distribution(-5, 5);
+    auto random = [&] () { return distribution(generator); };
+
+    int failures = 0;
+    for (size_t n : {1, 2, 5, 12}) {
+        Matrix<ArbInterval> M = random_matrix(n, 8, random);
+        ArbInterval node = det_node(M);
+        ArbInterval scalar = det_scalar(M);
+        if (!agree(node, scalar)) {
+            std::cout << "n = " << n << ": det errors " << node << " "
+                      << scalar << "\n";
+            ++failures;
+        }
+
+        Matrix<ArbInterval> S = random_linear_system(n, 8, random);
+        std::vector<ArbInterval> x_node = solve_node(S);
+        std::vector<ArbInterval> x_scalar = solve_scalar(S);
+        for (size_t i = 0; i < n; ++i) {
+            if (!agree(x_node[i], x_scalar[i])) {
+                std::cout << "n = " << n << ": x" << i << " errors "
+                          << x_node[i] << " " << x_scalar[i] << "\n";
+                ++failures;
+            }
+        }
+    }
+
+    std::cout << (failures == 0 ? "OK" : "FAILED") << "\n";
+    return failures == 0 ? 0 : 1;
+}
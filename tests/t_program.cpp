@@ -0,0 +1,183 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+#include "../apost.h"
+#include "../apost_program.h"
+#include "../dets.h"
+#include "../random_matrix.h"
+
+#include <iostream>
+#include <random>
+
+/*
+    This file contains tests of Program: checkpointed replay gives the
+    same results as unbounded one, budgets less than the program needs
+    and inputs of another size are reported, different pivot choice
+    makes replay_or_record() record the kernel again.
+*/
+
+using namespace interval;
+using namespace apost;
+
+typedef std::vector<ProxyInterval<ArbInterval>> Inputs;
+
+// Returns true if evaluate() with budget gives expected result.
+bool check_budget(const Program<ArbInterval>& recorded,
+        const std::vector<ArbInterval>& inputs, size_t budget,
+        const ArbInterval& expected) {
+    Program<ArbInterval> program = recorded;
+    program.set_budget(budget);
+
+    ArbInterval result;
+    Program<ArbInterval>::Status status = program.evaluate(inputs, result);
+    if (status == Program<ArbInterval>::kOverBudget) {
+        return true;
+    }
+
+    return status == Program<ArbInterval>::kEvaluated &&
+           result.val() == expected.val() &&
+           result.error() == expected.error();
+}
+
+int main() {
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<double> distribution(-5, 5);
+    auto random = [&] () { return distribution(generator); };
+
+    size_t n = 8;
+    Matrix<ArbInterval> matrix = random_matrix(n, 6, random);
+    std::vector<ArbInterval> inputs;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            inputs.push_back(matrix.at(i, j));
+        }
+    }
+
+    // scalar elimination
+    auto scalar = [n] (const Inputs& x) {
+        Inputs a = x;
+        ProxyInterval<ArbInterval> det = a[0];
+        for (size_t k = 0; k < n; ++k) {
+            if (k != 0) {
+                det = det * a[k * n + k];
+            }
+            for (size_t i = k + 1; i < n; ++i) {
+                ProxyInterval<ArbInterval> l = a[i * n + k] / a[k * n + k];
+                for (size_t j = k + 1; j < n; ++j) {
+                    a[i * n + j] = fms(a[i * n + j], l, a[k * n + j]);
+                }
+            }
+        }
+        return det;
+    };
+
+    // determinant by LU node
+    auto node = [n] (const Inputs& x) {
+        Matrix<ProxyInterval<ArbInterval>> a(n, n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                a.at(i, j) = x[i * n + j];
+            }
+        }
+        return det_pivot(a) * (x[0] + x[n * n - 1]);
+    };
+
+    int failures = 0;
+    for (int kernel = 0; kernel < 2; ++kernel) {
+        Program<ArbInterval> program;
+        ArbInterval expected = kernel == 0 ?
+            replay_or_record(program, inputs, scalar) :
+            replay_or_record(program, inputs, node);
+
+        Program<ArbInterval> tiny = program;
+        tiny.set_budget(1);
+        ArbInterval result;
+        if (tiny.evaluate(inputs, result) != Program<ArbInterval>::kOverBudget) {
+            std::cout << "kernel " << kernel << ": budget 1 is accepted\n";
+            ++failures;
+        }
+
+        // small budget is reported, the kernel is not recorded again
+        int records = 0;
+        auto counted = [&] (const Inputs& x) {
+            ++records;
+            return kernel == 0 ? scalar(x) : node(x);
+        };
+        Program<ArbInterval>::Status status;
+        replay_or_record(tiny, inputs, counted, &status);
+        if (status != Program<ArbInterval>::kOverBudget || records != 0) {
+            std::cout << "kernel " << kernel
+                      << ": small budget is not reported\n";
+            ++failures;
+        }
+
+        bool evaluated = false;
+        for (size_t budget = 16; budget <= 4096; budget *= 2) {
+            if (!check_budget(program, inputs, budget, expected)) {
+                std::cout << "kernel " << kernel << ": budget " << budget
+                          << " result differs\n";
+                ++failures;
+            }
+
+            Program<ArbInterval> copy = program;
+            copy.set_budget(budget);
+            evaluated = evaluated ||
+                copy.evaluate(inputs, result) == Program<ArbInterval>::kEvaluated;
+        }
+
+        if (!evaluated) {
+            std::cout << "kernel " << kernel << ": no budget is enough\n";
+            ++failures;
+        }
+    }
+
+    // the first pivot is in row 0 for inputs and in row 1 for others
+    std::vector<ArbInterval> others = inputs;
+    inputs[0] = ArbInterval(100);
+    others[0] = ArbInterval(0.001);
+    others[n] = ArbInterval(100);
+
+    int records = 0;
+    auto counted = [&] (const Inputs& x) {
+        ++records;
+        return node(x);
+    };
+
+    Program<ArbInterval> program;
+    Program<ArbInterval>::Status status;
+    replay_or_record(program, inputs, counted, &status);
+
+    ArbInterval result;
+    if (program.evaluate(others, result) != Program<ArbInterval>::kPivotChanged) {
+        std::cout << "different pivot is not detected\n";
+        ++failures;
+    }
+
+    Program<ArbInterval> fresh;
+    ArbInterval expected = replay_or_record(fresh, others, node);
+    records = 0;
+    result = replay_or_record(program, others, counted, &status);
+    if (status != Program<ArbInterval>::kEvaluated || records != 1 ||
+            result.val() != expected.val() ||
+            result.error() != expected.error() ||
+            program.evaluate(others, result) != Program<ArbInterval>::kEvaluated) {
+        std::cout << "kernel is not recorded again for different pivot\n";
+        ++failures;
+    }
+
+    // inputs of another size are rejected without recording
+    std::vector<ArbInterval> short_inputs(inputs.begin(), inputs.end() - 1);
+    records = 0;
+    replay_or_record(program, short_inputs, counted, &status);
+    if (program.evaluate(short_inputs, result) !=
+            Program<ArbInterval>::kWrongInputs ||
+            status != Program<ArbInterval>::kWrongInputs || records != 0) {
+        std::cout << "inputs of another size are accepted\n";
+        ++failures;
+    }
+
+    std::cout << (failures == 0 ? "OK" : "FAILED") << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "precision.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+    This file contains simple thread pool for parallel matrix algorithms.
+
+    Tasks are run with the precision of the thread which submitted them,
+    so PrecisionScope of the caller applies to the workers too.
+
+    Tasks submitted by a worker thread of any pool (and tasks of a pool
+    without workers) are run in place, so a parallel algorithm called from
+    a task (e.g. lu_crout() in a batch of problems, see batch.h) is serial
+    and can not deadlock the pool.
+
+    An exception thrown by a task of a worker is kept and rethrown by
+    wait(), other tasks are still run.
+*/
+
+namespace interval {
+
+class ThreadPool {
+public:
+    // Starts nthreads workers. With nthreads <= 1 there are no workers
+    // and tasks are run by submit() itself.
+    explicit ThreadPool(size_t nthreads)
+    : pending_(0)
+    , stop_(false) {
+        for (size_t i = 0; nthreads > 1 && i < nthreads; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+    
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        task_ready_.notify_all();
+        
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    // Number of worker threads.
+    size_t size() const { return workers_.size(); }
+    
+    // Adds the task to the queue.
+    void submit(std::function<void()> task) {
+        int precision = getPrecision();
+        if (workers_.empty() || is_worker()) {
+            PrecisionScope scope(precision);
+            bool& worker = is_worker();
+            bool nested = worker;
+            worker = true;
+            try {
+                task();
+            } catch (...) {
+                worker = nested;
+                throw;
+            }
+            worker = nested;
+            return;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back([task, precision] {
+                PrecisionScope scope(precision);
+                task();
+            });
+            ++pending_;
+        }
+        task_ready_.notify_one();
+    }
+    
+    // Waits until all submitted tasks are done. Tasks of worker threads
+    // are done by submit(). Rethrows the first exception of the tasks.
+    void wait() {
+        if (is_worker()) {
+            return;
+        }
+        
+        std::unique_lock<std::mutex> lock(mutex_);
+        all_done_.wait(lock, [this] { return pending_ == 0; });
+        
+        if (error_) {
+            std::exception_ptr error;
+            std::swap(error, error_);
+            std::rethrow_exception(error);
+        }
+    }
+    
+private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    size_t pending_;
+    bool stop_;
+    // the first exception of tasks since the last wait()
+    std::exception_ptr error_;
+    
+    std::mutex mutex_;
+    std::condition_variable task_ready_;
+    std::condition_variable all_done_;
+    
+    // Returns true in worker threads of all pools.
+    static bool& is_worker() {
+        thread_local bool value = false;
+        return value;
+    }
+    
+    void work() {
+        is_worker() = true;
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                task_ready_.wait(lock, [this] {
+                    return stop_ || !tasks_.empty();
+                });
+                if (tasks_.empty()) {
+                    return;
+                }
+                
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            
+            std::exception_ptr error;
+            try {
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (error && !error_) {
+                error_ = error;
+            }
+            if (--pending_ == 0) {
+                all_done_.notify_all();
+            }
+        }
+    }
+};
+
+// Returns the pool with one worker per hardware thread.
+inline ThreadPool& default_pool() {
+    static ThreadPool pool(std::thread::hardware_concurrency());
+    return pool;
+}
+
+}  // namespace interval
+
+#endif  // THREAD_POOL_H
@@ -29,9 +29,31 @@ struct Value {
         arf_init(data_);
     }
     
+    Value(const Value& other)
+    : Value() {
+        arf_set(data_, other.data_);
+    }
+    
+    // Move constructor takes other limbs, other becomes zero.
+    Value(Value&& other)
+    : Value() {
+        arf_swap(data_, other.data_);
+    }
+    
     ~Value() {
         arf_clear(data_);
     }
+    
+    // Assignment.
+    Value& operator=(const Value& other) {
+        arf_set(data_, other.data_);
+        return *this;
+    }
+    
+    Value& operator=(Value&& other) {
+        arf_swap(data_, other.data_);
+        return *this;
+    }
 
     arf_t data_;
     
@@ -41,14 +63,14 @@ struct Value {
     }
     
     // Addition.
-    Value operator+(const Value& other) {
+    Value operator+(const Value& other) const {
         Value temp;
         arf_add(temp.data_, data_, other.data_, getPrecision(), ARF_RND_UP);
         
         return temp;
     }
     
-    Value operator/(const Value& other) {
+    Value operator/(const Value& other) const {
         Value temp;
         arf_div(temp.data_, data_, other.data_, getPrecision(), ARF_RND_UP);
         
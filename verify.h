@@ -0,0 +1,281 @@
+# Copyright (c) 2016 The Caroline authors. All rights reserved.
+# Use of this source file is governed by a MIT license that can be found in the
+# LICENSE file.
+# Author: Glazachev Vladimir <glazachev.vladimir@gmail.com>
+
+
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include "interval.h"
+#include "magnitude.h"
+#include "matrix.h"
+
+#include "flint/arb_mat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/*
+    This file contains verified linear equation system solver.
+
+    An approximate inverse R of midpoint matrix and an approximate solution
+    x~ are computed cheaply in double precision. Then the solution of
+    A x = b for all A, b in the input intervals is enclosed with a few
+    interval matrix products (Krawczyk operator, see [1]):
+        z = R (b - A x~),  C = I - R A.
+    If ||C|| < 1 then |x - x~| <= ||z|| / (1 - ||C||) = d, and
+        x in x~ + z + C [-d, d].
+    Radii do not blow up with n as in interval Gaussian elimination.
+
+    solve_refined() improves the approximate solution by iterative
+    refinement: the inverse is computed once in double precision, only
+    O(n^2) residuals are computed at current (high) precision.
+
+        [1] Rump, S.M., Verification methods: Rigorous results using
+            floating-point arithmetic, Acta Numerica, Volume 19, 2010,
+            pp. 287-449.
+*/
+
+namespace interval {
+
+// Returns midpoints of matrix elements rounded to double.
+inline Matrix<double> midpoint(const Matrix<ArbInterval>& A) {
+    Matrix<double> result(A.nrow(), A.ncol());
+    for (size_t i = 0; i < A.nrow(); ++i)
+        for (size_t j = 0; j < A.ncol(); ++j)
+            result.at(i, j) = arf_get_d(arb_midref(A.at(i, j).data()),
+                                        ARF_RND_NEAR);
+    
+    return result;
+}
+
+// Returns point interval matrix with A elements.
+inline Matrix<ArbInterval> to_interval(const Matrix<double>& A) {
+    Matrix<ArbInterval> result(A.nrow(), A.ncol());
+    for (size_t i = 0; i < A.nrow(); ++i)
+        for (size_t j = 0; j < A.ncol(); ++j)
+            result.at(i, j) = A.at(i, j);
+    
+    return result;
+}
+
+// Returns A * B computed in double precision.
+inline Matrix<double> mul(const Matrix<double>& A, const Matrix<double>& B) {
+    Matrix<double> C(A.nrow(), B.ncol());
+    for (size_t i = 0; i < A.nrow(); ++i)
+        for (size_t k = 0; k < A.ncol(); ++k)
+            for (size_t j = 0; j < B.ncol(); ++j)
+                C.at(i, j) += A.at(i, k) * B.at(k, j);
+    
+    return C;
+}
+
+// Computes approximate inverse of n*n matrix A in double precision
+// (Gauss-Jordan elimination with partial pivoting). Returns false
+// if A is singular in double precision.
+inline bool approximate_inverse(Matrix<double> A, Matrix<double>& R) {
+    size_t n = A.nrow();
+    
+    R = Matrix<double>(n, n);
+    for (size_t i = 0; i < n; ++i)
+        R.at(i, i) = 1;
+    
+    for (size_t i = 0; i < n; ++i) {
+        size_t p = i;
+        for (size_t r = i + 1; r < n; ++r)
+            if (std::fabs(A.at(r, i)) > std::fabs(A.at(p, i)))
+                p = r;
+        
+        if (A.at(p, i) == 0)
+            return false;
+        
+        for (size_t j = 0; j < n; ++j) {
+            std::swap(A.at(i, j), A.at(p, j));
+            std::swap(R.at(i, j), R.at(p, j));
+        }
+        
+        double d = A.at(i, i);
+        for (size_t j = 0; j < n; ++j) {
+            A.at(i, j) /= d;
+            R.at(i, j) /= d;
+        }
+        
+        for (size_t r = 0; r < n; ++r) {
+            double f = A.at(r, i);
+            if (r == i || f == 0)
+                continue;
+            
+            for (size_t j = 0; j < n; ++j) {
+                A.at(r, j) -= f * A.at(i, j);
+                R.at(r, j) -= f * R.at(i, j);
+            }
+        }
+    }
+    
+    return true;
+}
+
+// Encloses the solution of A X = B (A - n*n, B - n*k matrix) near
+// approximate point solution Xt using approximate inverse R of A.
+// Returns false if the enclosure can not be verified (||I - R A|| >= 1).
+// The residual B - A Xt is computed at current precision, other products
+// only need a few correct digits, they are computed with product_precision
+// (0 means current precision).
+inline bool verify_solution(const Matrix<ArbInterval>& A,
+        const Matrix<ArbInterval>& B, const Matrix<double>& R,
+        const Matrix<ArbInterval>& Xt, Matrix<ArbInterval>& X,
+        int product_precision = 0) {
+    size_t n = A.nrow();
+    size_t k = B.ncol();
+    int precision = getPrecision();
+    
+    Matrix<ArbInterval> Ri = to_interval(R);
+    
+    // residual B - A Xt
+    Matrix<ArbInterval> Z = mat_mul(A, Xt);
+    arb_mat_sub(Z.data(), B.data(), Z.data(), precision);
+    
+    PrecisionScope scope(product_precision);
+    
+    // C = I - R A
+    Matrix<ArbInterval> C = mat_mul(Ri, A);
+    arb_mat_neg(C.data(), C.data());
+    for (size_t i = 0; i < n; ++i)
+        C.at(i, i) += 1;
+    
+    // ||C|| (infinity norm)
+    Magnitude norm;
+    for (size_t i = 0; i < n; ++i) {
+        Magnitude row;
+        for (size_t j = 0; j < n; ++j)
+            row += C.at(i, j).mag();
+        if (row > norm)
+            norm = row;
+    }
+    
+    if (!(norm < Magnitude(1)))
+        return false;
+    
+    // lower bound of 1 - ||C||
+    Magnitude contraction;
+    mag_sub_lower(contraction.data(), Magnitude(1).data(), norm.data());
+    
+    // z = R (B - A Xt)
+    Z = mat_mul(Ri, Z);
+    
+    // Y = [-d, d], d = ||z|| / (1 - ||C||) for every column
+    Matrix<ArbInterval> Y(n, k);
+    for (size_t c = 0; c < k; ++c) {
+        Magnitude d;
+        for (size_t i = 0; i < n; ++i) {
+            Magnitude z = Z.at(i, c).mag();
+            if (z > d)
+                d = z;
+        }
+        mag_div(d.data(), d.data(), contraction.data());
+        
+        for (size_t i = 0; i < n; ++i)
+            Y.at(i, c) = ArbInterval(Value(), d.val());
+    }
+    
+    // X = Xt + z + C Y, Xt is added at full precision
+    X = mat_mul(C, Y);
+    arb_mat_add(X.data(), X.data(), Z.data(), getPrecision());
+    arb_mat_add(X.data(), X.data(), Xt.data(), precision);
+    
+    return true;
+}
+
+// Solves A X = B (A - n*n, B - n*k matrix) with verified method.
+// On success stores the enclosure of the solution to X and returns true.
+inline bool solve_verified(const Matrix<ArbInterval>& A,
+        const Matrix<ArbInterval>& B, Matrix<ArbInterval>& X) {
+    Matrix<double> Am = midpoint(A);
+    Matrix<double> Bm = midpoint(B);
+    
+    Matrix<double> R(0, 0);
+    if (!approximate_inverse(Am, R))
+        return false;
+    
+    // approximate solution with one refinement step
+    Matrix<double> Xt = mul(R, Bm);
+    Matrix<double> residual = mul(Am, Xt);
+    for (size_t i = 0; i < Bm.nrow(); ++i)
+        for (size_t j = 0; j < Bm.ncol(); ++j)
+            residual.at(i, j) = Bm.at(i, j) - residual.at(i, j);
+    
+    Matrix<double> dX = mul(R, residual);
+    for (size_t i = 0; i < Xt.nrow(); ++i)
+        for (size_t j = 0; j < Xt.ncol(); ++j)
+            Xt.at(i, j) += dX.at(i, j);
+    
+    return verify_solution(A, B, R, to_interval(Xt), X);
+}
+
+// Precision of O(n^3) products in solve_refined().
+const int kRefinePrecision = 64;
+
+// Solves A X = B (A - n*n, B - n*k matrix) with mixed-precision iterative
+// refinement. Midpoint matrix is factored (inverted) once in double
+// precision, then at most max_steps refinement steps
+//     Xt = Xt + R (mid B - mid A Xt)
+// are made, where only the residual is computed at current precision.
+// The result is enclosed by verify_solution(), so its error includes
+// the errors of A and B.
+// On success stores the enclosure of the solution to X and returns true.
+inline bool solve_refined(const Matrix<ArbInterval>& A,
+        const Matrix<ArbInterval>& B, Matrix<ArbInterval>& X,
+        size_t max_steps = 64) {
+    size_t n = B.nrow();
+    size_t k = B.ncol();
+    
+    Matrix<double> R(0, 0);
+    if (!approximate_inverse(midpoint(A), R))
+        return false;
+    
+    // exact midpoints
+    Matrix<ArbInterval> Am(n, n);
+    Matrix<ArbInterval> Bm(n, k);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j)
+            Am.at(i, j) = ArbInterval(A.at(i, j).val());
+        for (size_t j = 0; j < k; ++j)
+            Bm.at(i, j) = ArbInterval(B.at(i, j).val());
+    }
+    
+    Matrix<ArbInterval> Xt = to_interval(mul(R, midpoint(Bm)));
+    
+    double previous = INFINITY;
+    for (size_t step = 0; step < max_steps; ++step) {
+        Matrix<ArbInterval> residual = mat_mul(Am, Xt);
+        arb_mat_sub(residual.data(), Bm.data(), residual.data(),
+                    getPrecision());
+        
+        Matrix<double> dX = mul(R, midpoint(residual));
+        
+        double correction = 0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < k; ++j) {
+                correction = std::max(correction, std::fabs(dX.at(i, j)));
+                
+                // Xt stays a point value
+                Xt.at(i, j) += dX.at(i, j);
+                Xt.at(i, j) = ArbInterval(Xt.at(i, j).val());
+            }
+        }
+        
+        // converged or stagnates
+        if (correction == 0 || correction > previous / 2)
+            break;
+        previous = correction;
+    }
+    
+    return verify_solution(A, B, R, Xt, X, kRefinePrecision);
+}
+
+}  // namespace interval
+
+#endif  // VERIFY_H